@@ -5,6 +5,7 @@ find_package(Boost 1.56.0 COMPONENTS program_options REQUIRED)
 find_package(Git QUIET) # if we don't find git or FindGit.cmake is not on the system we ignore it.
 find_package(Configuration REQUIRED)
 find_package(Monitoring REQUIRED)
+find_package(Threads REQUIRED)
 
 ########## Bucket definitions ############
 
@@ -16,6 +17,7 @@ o2_define_bucket(
     ${Configuration_LIBRARIES}
     ${Monitoring_LIBRARIES}
     ${Boost_PROGRAM_OPTIONS_LIBRARY}
+    ${CMAKE_THREAD_LIBS_INIT}
 
     SYSTEMINCLUDE_DIRECTORIES
     ${Boost_INCLUDE_DIR}
@@ -0,0 +1,167 @@
+/// \file BatchWriter.cxx
+/// \brief Implementation of the BatchWriter class and its backends.
+
+#include "BatchWriter.h"
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+#include <boost/algorithm/string.hpp>
+#include "Encoding.h"
+#include "HttpClient.h"
+#include "MockConfiguration.h"
+
+namespace AliceO2
+{
+namespace ConfigurationBenchmark
+{
+namespace
+{
+constexpr size_t CONSUL_MAX_OPERATIONS = 64; ///< Consul rejects larger transactions
+constexpr size_t ETCD_MAX_OPERATIONS = 128; ///< Default '--max-txn-ops' of etcd
+constexpr size_t ETCD_V2_PIPELINE_DEPTH = 128; ///< Puts sent before reading their responses, bounds the buffers
+
+class ConsulBatchWriter : public BatchWriter
+{
+  public:
+    explicit ConsulBatchWriter(const HttpUri& uri)
+        : mClient(uri.host, uri.port), mPrefix(uri.prefix)
+    {
+    }
+
+    virtual void write(const ParameterSet& parameters, size_t begin, size_t end)
+    {
+      while (begin != end) {
+        auto chunkEnd = std::min(end, begin + CONSUL_MAX_OPERATIONS);
+        std::string body = "[";
+        for (auto i = begin; i != chunkEnd; ++i) {
+          // Consul keys have no leading slash
+          auto key = joinKey(mPrefix, parameters.key(i).to_string());
+          key.erase(0, key.find_first_not_of('/'));
+          body += i == begin ? "" : ",";
+          body += "{\"KV\":{\"Verb\":\"set\",\"Key\":" + jsonString(key) + ",\"Value\":\""
+              + base64Encode(parameters.value(i)) + "\"}}";
+        }
+        body += "]";
+
+        auto response = mClient.request("PUT", "/v1/txn", body);
+        if (response.status != 200) {
+          throw std::runtime_error("Consul transaction failed with status " + std::to_string(response.status)
+              + ": " + response.body);
+        }
+        begin = chunkEnd;
+      }
+    }
+
+  private:
+    HttpClient mClient;
+    std::string mPrefix;
+};
+
+/// etcd v2 has no transactions, so the puts of a batch are pipelined on the connection instead
+class EtcdV2BatchWriter : public BatchWriter
+{
+  public:
+    explicit EtcdV2BatchWriter(const HttpUri& uri)
+        : mClient(uri.host, uri.port), mPrefix(uri.prefix)
+    {
+    }
+
+    virtual void write(const ParameterSet& parameters, size_t begin, size_t end)
+    {
+      std::vector<HttpClient::Request> requests;
+      while (begin != end) {
+        auto chunkEnd = std::min(end, begin + ETCD_V2_PIPELINE_DEPTH);
+        requests.clear();
+        for (auto i = begin; i != chunkEnd; ++i) {
+          auto key = joinKey(mPrefix, parameters.key(i).to_string());
+          key.erase(0, key.find_first_not_of('/'));
+          requests.push_back({"PUT", "/v2/keys/" + urlEncode(key, true),
+              "value=" + urlEncode(parameters.value(i), false), "application/x-www-form-urlencoded"});
+        }
+
+        for (const auto& response : mClient.pipeline(requests)) {
+          if (response.status != 200 && response.status != 201) {
+            throw std::runtime_error("etcd put failed with status " + std::to_string(response.status) + ": "
+                + response.body);
+          }
+        }
+        begin = chunkEnd;
+      }
+    }
+
+  private:
+    HttpClient mClient;
+    std::string mPrefix;
+};
+
+class EtcdV3BatchWriter : public BatchWriter
+{
+  public:
+    explicit EtcdV3BatchWriter(const HttpUri& uri)
+        : mClient(uri.host, uri.port), mPrefix(uri.prefix)
+    {
+    }
+
+    virtual void write(const ParameterSet& parameters, size_t begin, size_t end)
+    {
+      while (begin != end) {
+        auto chunkEnd = std::min(end, begin + ETCD_MAX_OPERATIONS);
+        std::string body = "{\"success\":[";
+        for (auto i = begin; i != chunkEnd; ++i) {
+          body += i == begin ? "" : ",";
+          body += "{\"requestPut\":{\"key\":\"" + base64Encode(joinKey(mPrefix, parameters.key(i).to_string()))
+              + "\",\"value\":\"" + base64Encode(parameters.value(i)) + "\"}}";
+        }
+        body += "]}";
+
+        auto response = mClient.request("POST", "/v3/kv/txn", body);
+        if (response.status != 200) {
+          throw std::runtime_error("etcd transaction failed with status " + std::to_string(response.status)
+              + ": " + response.body);
+        }
+        begin = chunkEnd;
+      }
+    }
+
+  private:
+    HttpClient mClient;
+    std::string mPrefix;
+};
+
+class MockBatchWriter : public BatchWriter
+{
+  public:
+    explicit MockBatchWriter(const std::string& uri)
+        : mConfiguration(uri)
+    {
+    }
+
+    virtual void write(const ParameterSet& parameters, size_t begin, size_t end)
+    {
+      mConfiguration.putBatch(parameters, begin, end);
+    }
+
+  private:
+    MockConfiguration mConfiguration;
+};
+} // Anonymous namespace
+
+auto BatchWriter::create(const std::string& uri) -> std::unique_ptr<BatchWriter>
+{
+  if (MockConfiguration::isMockUri(uri)) {
+    return std::make_unique<MockBatchWriter>(uri);
+  }
+  if (boost::starts_with(uri, "consul://")) {
+    return std::make_unique<ConsulBatchWriter>(parseHttpUri(uri, "consul://", 8500));
+  }
+  if (boost::starts_with(uri, "etcd://")) {
+    return std::make_unique<EtcdV2BatchWriter>(parseHttpUri(uri, "etcd://", 2379));
+  }
+  if (boost::starts_with(uri, "etcd-v3://")) {
+    return std::make_unique<EtcdV3BatchWriter>(parseHttpUri(uri, "etcd-v3://", 2379));
+  }
+  return nullptr;
+}
+
+} // namespace ConfigurationBenchmark
+} // namespace AliceO2
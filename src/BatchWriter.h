@@ -0,0 +1,39 @@
+/// \file BatchWriter.h
+/// \brief Definition of the BatchWriter class, for putting key-values with the native batches of a backend.
+
+#ifndef ALICEO2_CONFIGURATIONBENCHMARK_BATCHWRITER_H
+#define ALICEO2_CONFIGURATIONBENCHMARK_BATCHWRITER_H
+
+#include <memory>
+#include <string>
+#include "ParameterSet.h"
+
+namespace AliceO2
+{
+namespace ConfigurationBenchmark
+{
+
+/// Puts key-values to a backend in batches, using its native transactions, which the ConfigurationInterface does not
+/// expose. Supported are Consul ("consul://HOST:PORT/PREFIX", /v1/txn), etcd v3 ("etcd-v3://HOST:PORT/PREFIX",
+/// /v3/kv/txn of the JSON gateway) and the mock backend. etcd v2 ("etcd://HOST:PORT/PREFIX", the keyspace the
+/// Configuration library reads) has no transactions, its puts are pipelined on one connection instead.
+/// Not thread-safe, use one writer per connection.
+class BatchWriter
+{
+  public:
+    virtual ~BatchWriter()
+    {
+    }
+
+    /// \return Writer for the URI, or nullptr if the backend has no native batches
+    static auto create(const std::string& uri) -> std::unique_ptr<BatchWriter>;
+
+    /// Puts the entries [begin, end) of the set. Batches larger than the limit of the backend are split into multiple
+    /// transactions.
+    virtual void write(const ParameterSet& parameters, size_t begin, size_t end) = 0;
+};
+
+} // namespace ConfigurationBenchmark
+} // namespace AliceO2
+
+#endif // ALICEO2_CONFIGURATIONBENCHMARK_BATCHWRITER_H
@@ -5,22 +5,50 @@
 ///
 /// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
 
+#include <pthread.h>
+#include <sched.h>
+#include <sys/wait.h>
 #include <unistd.h>
 #include <limits.h>
 #include <boost/algorithm/string.hpp>
 #include <boost/program_options.hpp>
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <cstdio>
+#include <ctime>
 #include <iostream>
 #include <iomanip>
 #include <fstream>
+#include <functional>
+#include <limits>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <thread>
+#include <type_traits>
 #include <map>
+#include <random>
 #include <set>
 #include <vector>
 #include "Configuration/ConfigurationFactory.h"
 #include "Monitoring/MonitoringFactory.h"
+#include "BatchWriter.h"
+#include "Clock.h"
+#include "Encoding.h"
+#include "Histogram.h"
+#include "KeyDistribution.h"
+#include "MockConfiguration.h"
+#include "ParameterGenerator.h"
+#include "ParameterSet.h"
+#include "ReplicatedConfiguration.h"
+#include "ShardedConfiguration.h"
+#include "SharedMemory.h"
+#include "StartBarrier.h"
+#include "TreeDigest.h"
+#include "ValueGenerator.h"
+#include "Verifier.h"
+#include "Watcher.h"
 
 namespace {
 
@@ -28,41 +56,150 @@ namespace {
 #define PARAM_MODE_COMBINED "combined"
 #define PARAM_MODE_FLAT "flat"
 #define PARAM_MODE_TREE "tree"
+#define ARRIVALS_CONSTANT "constant"
+#define ARRIVALS_POISSON "poisson"
+#define CONCURRENCY_PROCESSES "processes"
+#define CONCURRENCY_THREADS "threads"
+#define SERVER_POLICY_PID "pid"
+#define SERVER_POLICY_TWO_CHOICES "two-choices"
+#define SERVER_POLICY_HEDGED "hedged"
+#define SERVER_POLICY_FAN_OUT "fan-out"
 
 using namespace AliceO2;
+using ConfigurationBenchmark::BatchWriter;
+using ConfigurationBenchmark::Clock;
+using ConfigurationBenchmark::Histogram;
+using ConfigurationBenchmark::KeyDistribution;
+using ConfigurationBenchmark::MockConfiguration;
+using ConfigurationBenchmark::NumberedParameterGenerator;
+using ConfigurationBenchmark::Parameter;
+using ConfigurationBenchmark::ParameterGenerator;
+using ConfigurationBenchmark::ParameterSet;
+using ConfigurationBenchmark::ReplicatedConfiguration;
+using ConfigurationBenchmark::ScopedTimer;
+using ConfigurationBenchmark::StoredParameterGenerator;
+using ConfigurationBenchmark::ShardRing;
+using ConfigurationBenchmark::ShardedConfiguration;
+using ConfigurationBenchmark::SharedMemory;
+using ConfigurationBenchmark::StartBarrier;
+using ConfigurationBenchmark::TreeDigest;
+using ConfigurationBenchmark::ValueGenerator;
+using ConfigurationBenchmark::VerificationIndex;
+using ConfigurationBenchmark::Verifier;
+using ConfigurationBenchmark::Watcher;
+using ConfigurationBenchmark::appendDecimal;
 namespace po = boost::program_options;
 using ParameterMap = std::map<std::string, std::string>;
 using KeySet = std::set<std::string>;
 
+const std::string WATCH_PATH = "/watch"; ///< Subtree of the watch benchmark
+constexpr double DEFAULT_WATCH_TIMEOUT = 60.0; ///< Seconds
+
+/// Shape of the tree structure
+struct TreeShape
+{
+    int fanout; ///< Subdirectories per directory
+    int depth; ///< Maximum depth, or -1 for the smallest depth that fits the parameters
+    int keysPerDirectory;
+    int keyNameLength; ///< Minimum length of the key names, reached by zero-padding the number
+    std::vector<std::string> templateKeys; ///< Key paths of a real configuration to use instead, if not empty
+};
+
 struct Options
 {
     std::vector<std::string> serverUris;
     std::string monitoringConfigUri;
     std::string runId;
     std::string parameterStructure;
+    std::string keyDistribution;
+    std::string valueSize;
+    std::string valueContent;
+    TreeShape treeShape;
     int parameterNumber;
     int processNumber;
+    int putConcurrency;
+    std::vector<size_t> putBatchSizes;
+    int iterations;
+    int warmupIterations;
+    double duration;
+    double rate;
+    double startTime;
+    std::string arrivals;
+    std::string readWriteRatio;
+    double writeFraction; ///< Fraction of the operations that are writes, from readWriteRatio
+    std::string concurrencyModel;
+    std::string serverPolicy;
+    double hedgePercentile;
+    bool sharded;
+    bool watch;
+    int watchWrites;
+    int watchKeys;
+    double watchInterval;
+    double watchPollInterval;
+    bool lazyParameters;
     bool skipWait;
     bool skipCheckValues;
+    bool streamCheck;
+    bool digestCheck;
+    bool aggregateOnly;
     bool put;
     bool printParams;
     bool help;
     bool verbose;
 };
 
-bool sVerbose = true;
+thread_local bool sVerbose = true;
+
+/// Set once from the options, before starting any clients
+ValueGenerator sValueGenerator;
 
 auto log() -> std::ostream&
 {
-  static std::ofstream deadStream; // Unopened stream is essentially a '/dev/null'
+  thread_local std::ofstream deadStream; // Unopened stream is essentially a '/dev/null'
   return sVerbose ? std::cout : deadStream;
 }
 
+/// Reads the keys of a configuration dump, dropping directory entries and keys that are also directories, which a
+/// tree cannot have
+std::vector<std::string> loadTreeTemplate(const std::string& path)
+{
+  std::ifstream file(path);
+  if (!file) {
+    throw std::runtime_error("Failed to open tree template '" + path + "'");
+  }
+
+  std::vector<std::string> keys;
+  std::string line;
+  while (std::getline(file, line)) {
+    auto key = line.substr(0, line.find_first_of(",:= \t\r"));
+    boost::trim_if(key, boost::is_any_of("/"));
+    if (!key.empty() && line.find_first_of(",:= \t\r") != 0 && line.back() != '/') {
+      keys.push_back(key);
+    }
+  }
+
+  std::sort(keys.begin(), keys.end());
+  keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+  std::vector<std::string> leaves;
+  for (size_t i = 0; i < keys.size(); ++i) {
+    if (i + 1 == keys.size() || !boost::starts_with(keys[i + 1], keys[i] + "/")) {
+      leaves.push_back(keys[i]);
+    }
+  }
+
+  if (leaves.empty()) {
+    throw std::runtime_error("No keys in tree template '" + path + "'");
+  }
+  return leaves;
+}
+
 auto getOptions(int argc, char** argv) -> Options
 {
   Options options;
   std::string serverUris;
   std::string argumentsUri;
+  std::string putBatchSizes;
+  std::string treeTemplate;
 
   auto optionsDescription = po::options_description("Options");
   optionsDescription.add_options()
@@ -82,28 +219,150 @@ auto getOptions(int argc, char** argv) -> Options
       ("mon-uri",
           po::value<std::string>(&options.monitoringConfigUri),
          "URI for Monitoring configuration")
+      ("server-policy",
+          po::value<std::string>(&options.serverPolicy)->default_value(SERVER_POLICY_PID),
+          "How gets pick from multiple servers, which must be replicas ['" SERVER_POLICY_PID "', '"
+          SERVER_POLICY_TWO_CHOICES "', '" SERVER_POLICY_HEDGED "', '" SERVER_POLICY_FAN_OUT "']. '"
+          SERVER_POLICY_PID "' uses the server picked by PID, plus the thread index, for all gets. '"
+          SERVER_POLICY_TWO_CHOICES "' sends every get to the better of two random servers by observed latency. '"
+          SERVER_POLICY_HEDGED "' also sends a get to another server if the picked one did not respond after "
+          "'--hedge-percentile' of the observed latencies. '" SERVER_POLICY_FAN_OUT "' sends every get to all servers. "
+          "The first response is used")
+      ("hedge-percentile",
+          po::value<double>(&options.hedgePercentile)->default_value(95),
+          "Percentile of the observed latencies after which the '" SERVER_POLICY_HEDGED "' policy hedges a get")
+      ("sharded",
+          po::bool_switch(&options.sharded),
+          "Partition the keys over the servers with a consistent-hash ring, instead of every server holding all of "
+          "them. Puts write every key only to its server. Gets of single keys go to their servers, those of "
+          "different servers in parallel, and recursive gets go to all servers and merge the results")
       ("n-processes",
           po::value<int>(&options.processNumber)->default_value(1),
-          "Number of processes")
+          "Number of processes, or threads with '--concurrency-model=" CONCURRENCY_THREADS "'")
+      ("concurrency-model",
+          po::value<std::string>(&options.concurrencyModel)->default_value(CONCURRENCY_PROCESSES),
+          "How to run the clients ['" CONCURRENCY_PROCESSES "', '" CONCURRENCY_THREADS "']. Processes are forked and "
+          "each report their own results. Threads are pinned to cores and their results are merged and reported once")
       ("n-parameters",
           po::value<int>(&options.parameterNumber)->default_value(1),
           "Number of parameters per process")
+      ("iterations",
+          po::value<int>(&options.iterations)->default_value(1),
+          "Number of measured gets per process, all using the same connection")
+      ("warmup-iterations",
+          po::value<int>(&options.warmupIterations)->default_value(0),
+          "Number of unmeasured gets per process before the measured ones. The first is the cold get, which is done "
+          "even without warmup")
+      ("duration",
+          po::value<double>(&options.duration)->default_value(0),
+          "Seconds to keep doing measured gets for. Overrides '--iterations' if given")
+      ("rate",
+          po::value<double>(&options.rate)->default_value(0),
+          "Target aggregate requests per second over all processes. If given, the processes do open-loop getString() "
+          "requests of the parameter keys instead of closed-loop gets. The number of requests is '--duration' times "
+          "the rate, or otherwise '--iterations' times the number of keys")
+      ("arrivals",
+          po::value<std::string>(&options.arrivals)->default_value(ARRIVALS_CONSTANT),
+          "Open-loop request arrivals ['" ARRIVALS_CONSTANT "', '" ARRIVALS_POISSON "']")
+      ("read-write-ratio",
+          po::value<std::string>(&options.readWriteRatio)->default_value("1:0"),
+          "Mixed workload as 'READS:WRITES'. Every operation of the measured gets, or every request in open-loop mode, "
+          "is a write of a random parameter with probability WRITES/(READS+WRITES), putting back its expected value")
+      ("watch",
+          po::bool_switch(&options.watch),
+          "Instead of getting the parameters, the clients watch the '/watch' subtree while a writer thread updates "
+          "it, and report the delay from every write to its observation. Clients stop after observing the last update "
+          "or after '--duration' seconds, 60 by default")
+      ("watch-writes",
+          po::value<int>(&options.watchWrites)->default_value(100),
+          "Number of updates written in watch mode. Use 0 on nodes that only watch, while another node writes")
+      ("watch-keys",
+          po::value<int>(&options.watchKeys)->default_value(1),
+          "Number of keys in the watched subtree, updated round-robin")
+      ("watch-interval",
+          po::value<double>(&options.watchInterval)->default_value(0.1),
+          "Seconds between updates in watch mode")
+      ("watch-poll-interval",
+          po::value<double>(&options.watchPollInterval)->default_value(0.01),
+          "Seconds between polls for backends without a supported watch mechanism")
       ("structure",
           po::value<std::string>(&options.parameterStructure)->default_value(PARAM_MODE_SEPARATE),
           "Parameter structure ['" PARAM_MODE_SEPARATE "', '" PARAM_MODE_COMBINED "', '" PARAM_MODE_FLAT "', '"
           PARAM_MODE_TREE "']")
+      ("key-distribution",
+          po::value<std::string>(&options.keyDistribution)->default_value("sequential"),
+          "Which keys the '" PARAM_MODE_SEPARATE "' structure and open-loop requests get: 'sequential' (every key "
+          "once per get), 'uniform', 'zipf:SKEW' or 'hotspot:FRACTION:PROBABILITY' (the given fraction of the keys "
+          "gets the given probability of the requests). The random ones draw as many keys per get as there are "
+          "parameters")
+      ("value-size",
+          po::value<std::string>(&options.valueSize)->default_value("fixed:100"),
+          "Size of the parameter values in bytes: 'fixed:SIZE', 'uniform:MIN:MAX', 'lognormal:MEDIAN:SIGMA' or "
+          "'file:PATH' to draw from the sizes in the file, one per line")
+      ("value-content",
+          po::value<std::string>(&options.valueContent)->default_value("text"),
+          "Content of the parameter values: 'text' (compressible), 'random' (incompressible) or 'json'")
+      ("tree-fanout",
+          po::value<int>(&options.treeShape.fanout)->default_value(2),
+          "Subdirectories per directory of the '" PARAM_MODE_TREE "' structure")
+      ("tree-depth",
+          po::value<int>(&options.treeShape.depth)->default_value(-1),
+          "Maximum depth of the '" PARAM_MODE_TREE "' structure, by default the smallest that fits the parameters. "
+          "Directories are filled depth-first, so a larger depth gives a deeper and narrower tree")
+      ("keys-per-dir",
+          po::value<int>(&options.treeShape.keysPerDirectory)->default_value(5),
+          "Keys per directory of the '" PARAM_MODE_TREE "' structure")
+      ("key-name-length",
+          po::value<int>(&options.treeShape.keyNameLength)->default_value(0),
+          "Minimum length of the key names of the '" PARAM_MODE_TREE "' structure, reached by zero-padding")
+      ("tree-template",
+          po::value<std::string>(&treeTemplate),
+          "File with the keys of a real configuration, one per line, optionally followed by a value after a comma, "
+          "colon, equals sign or whitespace. The '" PARAM_MODE_TREE "' structure then uses these keys instead, "
+          "repeated in 'copyN' directories if there are more parameters than keys")
+      ("lazy-params",
+          po::bool_switch(&options.lazyParameters),
+          "Generate the keys and expected values of the '" PARAM_MODE_SEPARATE "' and '" PARAM_MODE_FLAT "' "
+          "structures on demand while getting, instead of storing them up front. Keys are then requested in numeric "
+          "instead of sorted order. The values of the last get are still kept for checking it, so for parameter "
+          "numbers that do not fit in memory, combine it with '--stream-check'")
       ("run-id",
           po::value<std::string>(&options.runId)->default_value(""),
           "Optional extra ID for result logs, e.g. for identifying a run")
       ("skip-wait",
           po::bool_switch(&options.skipWait),
-          "Skip wait until simulated start")
+          "Skip wait until simulated start. The clients of a node are still released together once all are ready")
+      ("start-time",
+          po::value<double>(&options.startTime)->default_value(0),
+          "Simulated start as wall-clock time in seconds since the Unix epoch, to start clients on multiple nodes "
+          "together. By default 10 seconds past the next minute")
       ("skip-check",
           po::bool_switch(&options.skipCheckValues),
           "Skip checking values returned form server")
+      ("stream-check",
+          po::bool_switch(&options.streamCheck),
+          "Check the values of every get as they arrive, instead of only those of the last get afterwards. The get "
+          "latency then includes the checks")
+      ("digest-check",
+          po::bool_switch(&options.digestCheck),
+          "Check the '" PARAM_MODE_FLAT "' and '" PARAM_MODE_TREE "' structures by comparing Merkle digests of the "
+          "returned and expected directories, computed once for the expected ones. Only the parameters of differing "
+          "directories are compared one by one, and the deepest differing directories are reported per server")
+      ("aggregate-only",
+          po::bool_switch(&options.aggregateOnly),
+          "With multiple processes, only send the results aggregated by the parent process to Monitoring, not those "
+          "of every process")
       ("put",
           po::bool_switch(&options.put),
           "Put to server instead of get, also skips wait")
+      ("put-concurrency",
+          po::value<int>(&options.putConcurrency)->default_value(4),
+          "Maximum number of puts in flight per server. All servers are put to concurrently")
+      ("put-batch-size",
+          po::value<std::string>(&putBatchSizes)->default_value("1"),
+          "Number of parameters per put, using the transactions of the backend where supported (Consul, etcd-v3, "
+          "mock), pipelined puts for etcd v2, and otherwise individual puts. Can give multiple separated by comma, to "
+          "put once with each")
       ("print-params",
           po::bool_switch(&options.printParams),
           "Print the parameter data in csv format and exit");
@@ -142,40 +401,102 @@ auto getOptions(int argc, char** argv) -> Options
     po::notify(map);
   }
 
-  if (serverUris.empty()) {
-    throw std::runtime_error("Must specify server URI with '--uri' option");
+  if (options.processNumber < 1 || options.parameterNumber < 1) {
+    throw std::runtime_error("Number of processes and parameters must be positive");
   }
 
-  // Server URIs may be comma-separated
-  boost::split(options.serverUris, serverUris, boost::is_any_of(","), boost::token_compress_on);
+  if (options.iterations < 1 || options.warmupIterations < 0 || options.duration < 0) {
+    throw std::runtime_error("Iterations must be positive, warmup iterations and duration must not be negative");
+  }
 
-  return options;
-}
+  if (options.rate < 0) {
+    throw std::runtime_error("Rate must not be negative");
+  }
 
-void waitUntilNextInterval()
-{
-  using std::chrono::system_clock;
+  if (options.putConcurrency < 1) {
+    throw std::runtime_error("Put concurrency must be positive");
+  }
+
+  {
+    std::vector<std::string> ratio;
+    boost::split(ratio, options.readWriteRatio, boost::is_any_of(":"));
+    if (ratio.size() != 2) {
+      throw std::runtime_error("invalid 'read-write-ratio' option, expected 'READS:WRITES'");
+    }
+    auto reads = boost::lexical_cast<double>(ratio[0]);
+    auto writes = boost::lexical_cast<double>(ratio[1]);
+    if (reads <= 0 || writes < 0) {
+      throw std::runtime_error("Read part of read-write ratio must be positive, write part must not be negative");
+    }
+    options.writeFraction = writes / (reads + writes);
+  }
+
+  if (options.watchWrites < 0 || options.watchKeys < 1 || options.watchInterval < 0 || options.watchPollInterval < 0) {
+    throw std::runtime_error("Watch writes must not be negative, watch keys must be positive, watch intervals must not "
+        "be negative");
+  }
+
+  if (options.concurrencyModel != CONCURRENCY_PROCESSES && options.concurrencyModel != CONCURRENCY_THREADS) {
+    throw std::runtime_error("invalid 'concurrency-model' option");
+  }
 
-  // Get current time
-  auto now = system_clock::to_time_t(system_clock::now());
-  auto currentTime = *std::localtime(&now);
+  if (options.arrivals != ARRIVALS_CONSTANT && options.arrivals != ARRIVALS_POISSON) {
+    throw std::runtime_error("invalid 'arrivals' option");
+  }
 
-  log() << "Current time " << currentTime.tm_hour << ':' << currentTime.tm_min << ':' << currentTime.tm_sec << '\n';
+  if (options.serverPolicy != SERVER_POLICY_PID && options.serverPolicy != SERVER_POLICY_TWO_CHOICES
+      && options.serverPolicy != SERVER_POLICY_HEDGED && options.serverPolicy != SERVER_POLICY_FAN_OUT) {
+    throw std::runtime_error("invalid 'server-policy' option");
+  }
 
-  // Set time for next 1 minute and 10 seconds
-  auto nextTime = currentTime;
+  if (options.hedgePercentile < 0 || options.hedgePercentile > 100) {
+    throw std::runtime_error("Hedge percentile must be between 0 and 100");
+  }
 
-  if (nextTime.tm_sec < 10) {
-    nextTime.tm_sec = 10;
-  } else {
-    nextTime.tm_min = nextTime.tm_min + 1;
-    nextTime.tm_sec = 10;
+  if (options.sharded && options.serverPolicy != SERVER_POLICY_PID) {
+    throw std::runtime_error("Sharded servers hold different keys, a server policy cannot be used");
+  }
+
+  if (options.sharded && options.watch) {
+    throw std::runtime_error("Watchers watch a single server, which only holds its own share of sharded keys");
+  }
+
+  if (options.digestCheck && options.parameterStructure != PARAM_MODE_FLAT
+      && options.parameterStructure != PARAM_MODE_TREE) {
+    throw std::runtime_error("Digest check is only supported by the '" PARAM_MODE_FLAT "' and '" PARAM_MODE_TREE
+        "' structures");
+  }
+
+  if (options.digestCheck && options.lazyParameters) {
+    throw std::runtime_error("Digest check needs the stored parameters, it cannot be combined with lazy parameters");
+  }
+
+  if (serverUris.empty()) {
+    throw std::runtime_error("Must specify server URI with '--uri' option");
+  }
+
+  // Server URIs may be comma-separated
+  boost::split(options.serverUris, serverUris, boost::is_any_of(","), boost::token_compress_on);
+
+  if (options.treeShape.fanout < 1 || options.treeShape.depth < -1 || options.treeShape.keysPerDirectory < 1) {
+    throw std::runtime_error("Tree fanout and keys per directory must be positive, depth must not be negative");
+  }
+
+  if (!treeTemplate.empty()) {
+    options.treeShape.templateKeys = loadTreeTemplate(treeTemplate);
   }
 
-  log() << "Sleeping until " << nextTime.tm_hour << ':' << nextTime.tm_min << ':' << nextTime.tm_sec << '\n';
+  std::vector<std::string> batchSizes;
+  boost::split(batchSizes, putBatchSizes, boost::is_any_of(","), boost::token_compress_on);
+  for (const auto& batchSize : batchSizes) {
+    auto size = boost::lexical_cast<int>(batchSize);
+    if (size < 1) {
+      throw std::runtime_error("Put batch size must be positive");
+    }
+    options.putBatchSizes.push_back(size);
+  }
 
-  // Sleep until next minute
-  std::this_thread::sleep_until(system_clock::from_time_t(mktime(&nextTime)));
+  return options;
 }
 
 std::string flatParameterPath(int nParameters)
@@ -188,99 +509,135 @@ std::string treeParameterPath(int nParameters)
   return "/tree" + boost::lexical_cast<std::string>(nParameters);
 }
 
-std::string makeValue(int number)
+/// Total size of the values of the first n parameters, to reserve the arena
+size_t valueBytes(int nParameters)
 {
-  std::stringstream stringstream;
-  stringstream << "value" << std::setw(95) << std::setfill('0') << number;
-  return stringstream.str();
+  size_t bytes = 0;
+  for (int i = 0; i < nParameters; ++i) {
+    bytes += sValueGenerator.size(i);
+  }
+  return bytes;
 }
 
-int checkReturnedParameters(ParameterMap& generatedMap, ParameterMap& returnedMap)
+/// Adds the parameter with the given number, writing the key with the given function
+template <typename KeyWriter>
+void addParameter(ParameterSet& parameters, int number, KeyWriter writeKey)
 {
-  int mismatches = 0;
-
-  if (generatedMap.size() != returnedMap.size()) {
-    log() << "Mismatch of size"
-        << " generated:" << generatedMap.size()
-        << " returned:" << returnedMap.size() << '\n';
-  }
+  parameters.emplace(writeKey, [&](std::string& arena) { sValueGenerator.append(number, arena); });
+}
 
-  for (auto& parameter : generatedMap) {
-    if (returnedMap.count(parameter.first) == 0) {
-      // They key does not exist in the returned list
-      mismatches++;
-      log() << "Mismatch for key:" << parameter.first
+void logMismatch(const Verifier::Mismatch& mismatch)
+{
+  switch (mismatch.type) {
+    case Verifier::Mismatch::Type::Different:
+      log() << "Mismatch for key:" << mismatch.key
+          << " expected:" << mismatch.expected
+          << " returned:" << mismatch.returned << '\n';
+      break;
+    case Verifier::Mismatch::Type::Missing:
+      log() << "Mismatch for key:" << mismatch.key
           << " not found in returned list\n";
-      continue;
-    }
-
-    if (returnedMap[parameter.first] != parameter.second) {
-      // The values are not identical
-      mismatches++;
-      log() << "Mismatch for key:" << parameter.first
-          << " expected:" << parameter.second
-          << " returned:" << returnedMap[parameter.first] << '\n';
-      continue;
-    }
+      break;
+    case Verifier::Mismatch::Type::Unexpected:
+      log() << "Mismatch for key:" << mismatch.key
+          << " not expected\n";
+      break;
   }
-
-  return mismatches;
 }
 
 /// Creates a list of parameters and values
 ///
 /// The test keys and values are:
 /// /key[0...nParams - 1] -> [0...nParams - 1]
-ParameterMap createParameterMapSeparate(int nParams)
+const std::string SEPARATE_KEY_PREFIX = "/separate/key";
+
+ParameterSet createParameterSetSeparate(int nParams)
 {
-  ParameterMap parameterMap;
-  std::string keyPrefix = "/separate/key";
-  int pathMin = 0;
-  int pathMax = nParams - 1;
+  ParameterSet parameters;
+  const std::string& keyPrefix = SEPARATE_KEY_PREFIX;
+  parameters.reserve(nParams, size_t(nParams) * (keyPrefix.size() + 10) + valueBytes(nParams));
 
-  for (int i = pathMin; i <= pathMax; ++i) {
-    parameterMap.emplace(keyPrefix + boost::lexical_cast<std::string>(i), makeValue(i));
+  for (int i = 0; i < nParams; ++i) {
+    addParameter(parameters, i, [&](std::string& arena) {
+      arena += keyPrefix;
+      appendDecimal(i, 0, arena);
+    });
   }
 
-  return parameterMap;
+  parameters.sort();
+  return parameters;
 }
 
-/// Creates a ParameterMap with a single entry that combines multiple parameters
+/// Creates a ParameterSet with a single entry that combines multiple parameters
 /// Uses 16 characters per parameter
-ParameterMap createParameterMapCombined(int nParams)
+ParameterSet createParameterSetCombined(int nParams)
 {
-  ParameterMap parameterMap;
-  std::stringstream stringstream;
+  ParameterSet parameters;
+  const std::string key = "/combined/key" + std::to_string(nParams);
+  parameters.reserve(1, key.size() + size_t(nParams) * (3 + 10 + 1 + 1) + valueBytes(nParams));
+
+  parameters.emplace([&](std::string& arena) { arena += key; }, [&](std::string& arena) {
+    for (int i = 0; i < nParams; ++i) {
+      arena += "key";
+      appendDecimal(i, 0, arena);
+      arena += '=';
+      sValueGenerator.append(i, arena);
+      arena += '|';
+    }
+  });
 
-  for (int i = 0; i < nParams; ++i) {
-    stringstream << "key" << i << "=value" << std::setw(95) << std::setfill('0') << i << '|';
-  }
+  parameters.sort();
+  return parameters;
+}
 
-  parameterMap.emplace("/combined/key" + boost::lexical_cast<std::string>(nParams), stringstream.str());
-  return parameterMap;
+std::string flatKeyPrefix(int nParameters)
+{
+  return flatParameterPath(nParameters) + "/key";
 }
 
-ParameterMap createParameterMapFlat(int nParameters)
+ParameterSet createParameterSetFlat(int nParameters)
 {
-  ParameterMap parameterMap;
-  std::string pathPrefix = flatParameterPath(nParameters) + "/";
+  ParameterSet parameters;
+  const std::string keyPrefix = flatKeyPrefix(nParameters);
+  parameters.reserve(nParameters, size_t(nParameters) * (keyPrefix.size() + 10) + valueBytes(nParameters));
 
   for (int i = 0; i < nParameters; ++i) {
-    parameterMap.emplace(pathPrefix + "key" + boost::lexical_cast<std::string>(i), makeValue(i));
+    addParameter(parameters, i, [&](std::string& arena) {
+      arena += keyPrefix;
+      appendDecimal(i, 0, arena);
+    });
+  }
+
+  parameters.sort();
+  return parameters;
+}
+
+/// Name of the n-th subdirectory: "dirA" to "dirZ", then "dirAA", "dirAB", etc.
+std::string treeDirectoryName(int n)
+{
+  std::string letters;
+  for (n += 1; n > 0; n = (n - 1) / 26) {
+    letters.insert(letters.begin(), char('A' + (n - 1) % 26));
   }
+  return "dir" + letters;
+}
 
-  return parameterMap;
+/// Appends the name of the key: "key" followed by the number, zero-padded to the key name length
+void appendTreeKeyName(int number, const TreeShape& shape, std::string& buffer)
+{
+  buffer += "key";
+  appendDecimal(number, std::max(0, shape.keyNameLength - 3), buffer);
 }
 
-/// Recursive helper function for createParameterMapTree()
-void _createParameterMapTreeRecursive(
+/// Recursive helper function for createParameterSetTree()
+void _createParameterSetTreeRecursive(
     const int nParameters,
     int& currentParameters,
     const int neededDepth,
     int currentDepth,
     const std::string currentDirKey,
-    const int maxParametersPerDirectory,
-    ParameterMap& parameterMap)
+    const TreeShape& shape,
+    ParameterSet& parameters)
 {
   if (currentDepth > neededDepth) {
     return;
@@ -291,85 +648,340 @@ void _createParameterMapTreeRecursive(
   }
 
   int addedParameters = 0;
-  while (currentParameters < nParameters && addedParameters < 5) {
-    parameterMap.emplace(currentDirKey + "/key" + boost::lexical_cast<std::string>(currentParameters),
-        makeValue(currentParameters));
+  while (currentParameters < nParameters && addedParameters < shape.keysPerDirectory) {
+    addParameter(parameters, currentParameters, [&](std::string& arena) {
+      arena += currentDirKey;
+      arena += '/';
+      appendTreeKeyName(currentParameters, shape, arena);
+    });
 
     currentParameters++;
     addedParameters++;
   }
 
-  _createParameterMapTreeRecursive(nParameters, currentParameters, neededDepth, currentDepth + 1,
-      currentDirKey + "/dirA", maxParametersPerDirectory, parameterMap);
+  for (int i = 0; i < shape.fanout; ++i) {
+    _createParameterSetTreeRecursive(nParameters, currentParameters, neededDepth, currentDepth + 1,
+        currentDirKey + "/" + treeDirectoryName(i), shape, parameters);
+  }
+}
+
+/// Creates the parameters from the keys of the template, under "copyN" directories once the keys run out
+ParameterSet createParameterSetTreeFromTemplate(int nParameters, const TreeShape& shape)
+{
+  ParameterSet parameters;
+  const std::string root = treeParameterPath(nParameters);
+  const auto& keys = shape.templateKeys;
+  parameters.reserve(nParameters, valueBytes(nParameters));
+
+  for (int i = 0; i < nParameters; ++i) {
+    addParameter(parameters, i, [&](std::string& arena) {
+      arena += root;
+      if (auto copy = size_t(i) / keys.size()) {
+        arena += "/copy";
+        appendDecimal(copy, 0, arena);
+      }
+      arena += '/';
+      arena += keys[size_t(i) % keys.size()];
+    });
+  }
 
-  _createParameterMapTreeRecursive(nParameters, currentParameters, neededDepth, currentDepth + 1,
-      currentDirKey + "/dirB", maxParametersPerDirectory, parameterMap);
+  parameters.sort();
+  return parameters;
 }
 
-ParameterMap createParameterMapTree(int nParameters)
+ParameterSet createParameterSetTree(int nParameters, const TreeShape& shape)
 {
-  ParameterMap parameterMap;
+  if (!shape.templateKeys.empty()) {
+    return createParameterSetTreeFromTemplate(nParameters, shape);
+  }
+
+  ParameterSet parameters;
   std::string currentDirKey = treeParameterPath(nParameters);
 
   int currentParameters = 0;
 
-  auto findDepth = [](int nParameters, int paramsPerLevel){
-    int depth = 0;
-    int maxElements = 0;
-    for (;;) {
-      maxElements += ::pow(2, depth) * paramsPerLevel;
-
-      if (nParameters <= maxElements) {
-        return depth;
-      }
+  /// Number of keys that fit in a tree of the given depth
+  auto capacity = [&](int depth) {
+    double keys = 0;
+    for (int i = 0; i <= depth; ++i) {
+      keys += std::pow(double(shape.fanout), i) * shape.keysPerDirectory;
+    }
+    return keys;
+  };
 
+  auto findDepth = [&](int nParameters){
+    int depth = 0;
+    while (capacity(depth) < nParameters) {
       depth++;
     }
+    return depth;
   };
 
-  int maxParametersPerDirectory = 5;  int neededDepth = findDepth(nParameters, maxParametersPerDirectory);
+  int neededDepth = shape.depth >= 0 ? shape.depth : findDepth(nParameters);
+  if (capacity(neededDepth) < nParameters) {
+    throw std::runtime_error("Tree of depth " + std::to_string(neededDepth) + " cannot hold "
+        + std::to_string(nParameters) + " parameters");
+  }
   int currentDepth = 0;
 
-  _createParameterMapTreeRecursive(nParameters, currentParameters, neededDepth, currentDepth, currentDirKey,
-      maxParametersPerDirectory, parameterMap);
+  parameters.reserve(nParameters, size_t(nParameters) * (currentDirKey.size() + 32) + valueBytes(nParameters));
+  _createParameterSetTreeRecursive(nParameters, currentParameters, neededDepth, currentDepth, currentDirKey,
+      shape, parameters);
 
-  return parameterMap;
+  parameters.sort();
+  return parameters;
 }
 
-void putParametersToServer(Configuration::ConfigurationInterface* configuration, const ParameterMap& parameterMap)
+/// Latencies of the individual requests made by a process
+struct RequestLatency
+{
+    Histogram histogram;
+    std::string slowestKey;
+    uint64_t slowestNanoseconds = 0;
+    uint64_t totalNanoseconds = 0; ///< Time spent waiting for the backend
+    uint64_t failures = 0; ///< Requests that returned no value
+
+    void record(const std::string& key, uint64_t nanoseconds)
+    {
+      histogram.record(nanoseconds);
+      totalNanoseconds += nanoseconds;
+      if (nanoseconds > slowestNanoseconds) {
+        slowestNanoseconds = nanoseconds;
+        slowestKey = key;
+      }
+    }
+
+    void reset()
+    {
+      histogram.reset();
+      slowestKey.clear();
+      slowestNanoseconds = 0;
+      totalNanoseconds = 0;
+      failures = 0;
+    }
+};
+
+/// Client-side time of the gets per phase, in nanoseconds. Accumulated like RequestLatency::totalNanoseconds, so
+/// every get records the difference.
+struct PhaseTimes
+{
+    uint64_t flatten = 0; ///< Flattening returned trees into key-value pairs
+    uint64_t decode = 0; ///< Converting the values of returned trees into strings
+    uint64_t verify = 0; ///< Handing the returned parameters to the check: checking them, or storing them for later
+    uint64_t trees = 0; ///< Number of returned trees flattened
+};
+
+/// Puts every stride-th batch of parameters, starting from the first-th, timing each batch
+/// \param writer Writer for native batches, or nullptr to put the parameters of a batch one by one. Those puts are not
+///   pipelined, which the ConfigurationInterface does not allow as it blocks until each put is done.
+void putParametersToServer(Configuration::ConfigurationInterface* configuration,
+    BatchWriter* writer, const ParameterSet& parameters, size_t batchSize,
+    size_t first, size_t stride, Histogram& latency)
 {
   log() << "Putting key-values: \n";
-  for (const auto& kv : parameterMap) {
-    log() << " - " << kv.first << " -> " << kv.second << '\n';
-    configuration->putString(kv.first, kv.second);
+  for (size_t batch = first; batch * batchSize < parameters.size(); batch += stride) {
+    auto begin = batch * batchSize;
+    auto end = std::min(parameters.size(), (batch + 1) * batchSize);
+    for (auto i = begin; i != end; ++i) {
+      log() << " - " << parameters.key(i) << " -> " << parameters.value(i) << '\n';
+    }
+
+    auto start = Clock::now();
+    if (writer) {
+      writer->write(parameters, begin, end);
+    } else {
+      for (auto i = begin; i != end; ++i) {
+        configuration->putString(parameters.key(i).to_string(), parameters.value(i).to_string());
+      }
+    }
+    latency.record(Clock::since(start));
   }
 }
 
-ParameterMap getParametersFromServer(Configuration::ConfigurationInterface* configuration, const ParameterMap& keys)
+/// \return The value, or none if the request failed, which is counted in the latency's failures
+boost::optional<std::string> getParameterFromServer(Configuration::ConfigurationInterface* configuration,
+    const std::string& key, RequestLatency& latency)
 {
-  ParameterMap map;
-  log() << "Getting keys: \n";
-  for (const auto& kv : keys) {
-    log() << " - " << kv.first << '\n';
-    if (auto value = configuration->getString(kv.first)) {
-      map.emplace(kv.first, *value);
-    } else {
-      throw std::runtime_error("Failed to get key '" + kv.first + "'");
+  log() << " - " << key << '\n';
+  auto start = Clock::now();
+  auto value = configuration->getString(key);
+  latency.record(key, Clock::since(start));
+  if (!value) {
+    log() << "Failed to get key '" << key << "'\n";
+    latency.failures++;
+  }
+  return value;
+}
+
+/// Receives the returned parameters as they arrive, and without a value the keys of the requests that failed. The
+/// string_refs are only valid during the call.
+using ParameterSink = std::function<void(boost::string_ref key, boost::optional<boost::string_ref> value)>;
+
+/// Keys of a sharded get are requested in chunks of this many, so the servers work in parallel while the memory of
+/// the responses stays bounded
+constexpr size_t SHARDED_GET_CHUNK = 1024;
+
+/// Gets keys from sharded servers, those of different servers in parallel
+/// \param key Gives the i-th key, valid until the next call
+void getParametersFromShards(ShardedConfiguration& configuration, size_t nKeys,
+    const std::function<boost::string_ref(size_t)>& key, RequestLatency& latency, PhaseTimes& phases,
+    const ParameterSink& sink)
+{
+  log() << "Getting keys from shards:\n";
+  std::vector<std::string> keys;
+  for (size_t begin = 0; begin < nKeys; begin += SHARDED_GET_CHUNK) {
+    keys.clear();
+    for (size_t i = begin; i < std::min(nKeys, begin + SHARDED_GET_CHUNK); ++i) {
+      keys.push_back(key(i).to_string());
     }
+
+    auto responses = configuration.getStrings(keys);
+    for (size_t i = 0; i < keys.size(); ++i) {
+      log() << " - " << keys[i] << '\n';
+      latency.record(keys[i], responses[i].latency);
+      ScopedTimer timer(phases.verify);
+      if (!responses[i].value) {
+        log() << "Failed to get key '" << keys[i] << "'\n";
+        latency.failures++;
+        sink(keys[i], boost::none);
+        continue;
+      }
+      sink(keys[i], boost::string_ref(*responses[i].value));
+    }
+  }
+}
+
+void getParametersFromServer(Configuration::ConfigurationInterface* configuration, ParameterGenerator& keys,
+    RequestLatency& latency, PhaseTimes& phases, const ParameterSink& sink)
+{
+  if (auto sharded = dynamic_cast<ShardedConfiguration*>(configuration)) {
+    getParametersFromShards(*sharded, keys.size(), [&](size_t i) { return keys.get(i).key; }, latency, phases,
+        sink);
+    return;
+  }
+
+  log() << "Getting keys: \n";
+  std::string key;
+  for (size_t i = 0; i < keys.size(); ++i) {
+    auto generated = keys.get(i).key;
+    key.assign(generated.data(), generated.size());
+    auto value = getParameterFromServer(configuration, key, latency);
+    ScopedTimer timer(phases.verify);
+    sink(key, value ? boost::make_optional(boost::string_ref(*value)) : boost::none);
   }
-  return map;
 }
 
-ParameterMap getParametersFromServerRecursive(Configuration::ConfigurationInterface* configuration, std::string key)
+Configuration::Tree::Node getTreeFromServer(Configuration::ConfigurationInterface* configuration,
+    const std::string& key, RequestLatency& latency)
 {
-  ParameterMap map;
   log() << "Getting recursive: " << key << '\n';
+  auto start = Clock::now();
   Configuration::Tree::Node node = configuration->getRecursive(key);
-  auto keyValues = Configuration::Tree::treeToKeyValues(node);
-  for (const auto& kv : keyValues) {
-    map.emplace(key + kv.first, Configuration::Tree::convert<std::string>(kv.second));
-  }
-  return map;
+  latency.record(key, Clock::since(start));
+  return node;
+}
+
+/// Walks a returned tree and passes its parameters to a sink, without flattening it into key-value pairs first.
+/// Parameters are gathered in batches, with their full paths in a reused buffer and string values referenced in
+/// place, so the phases are timed per batch instead of per parameter.
+class TreeWalker
+{
+  public:
+    TreeWalker(PhaseTimes& phases, const ParameterSink& sink)
+        : mPhases(phases), mSink(sink), mDecode(0), mStart(0)
+    {
+      mEntries.reserve(BATCH_SIZE);
+    }
+
+    /// \param path Path of the node, used as buffer for the paths below it
+    void walk(const Configuration::Tree::Node& node, std::string& path)
+    {
+      mStart = Clock::now();
+      visit(node, path);
+      flush();
+    }
+
+  private:
+    static constexpr size_t BATCH_SIZE = 1024;
+
+    struct Entry
+    {
+        size_t keyOffset;
+        size_t keyLength;
+        const std::string* value; ///< The value in the tree, or nullptr if it was converted into mValues
+        size_t valueOffset;
+        size_t valueLength;
+    };
+
+    void visit(const Configuration::Tree::Node& node, std::string& path)
+    {
+      if (auto branch = boost::get<Configuration::Tree::Branch>(&node)) {
+        auto length = path.size();
+        for (const auto& child : *branch) {
+          path.resize(length);
+          path += '/';
+          path += child.first;
+          visit(child.second, path);
+        }
+        path.resize(length);
+        return;
+      }
+
+      Entry entry{mKeys.size(), path.size(), nullptr, 0, 0};
+      mKeys += path;
+      const auto& leaf = boost::get<Configuration::Tree::Leaf>(node);
+      entry.value = boost::get<std::string>(&leaf);
+      if (!entry.value) {
+        ScopedTimer timer(mDecode);
+        entry.valueOffset = mValues.size();
+        mValues += Configuration::Tree::convert<std::string>(leaf);
+        entry.valueLength = mValues.size() - entry.valueOffset;
+      }
+      mEntries.push_back(entry);
+      if (mEntries.size() == BATCH_SIZE) {
+        flush();
+      }
+    }
+
+    /// Passes the batch to the sink, and accounts the walk up to here to the flatten and decode phases
+    void flush()
+    {
+      auto walked = Clock::since(mStart);
+      mPhases.flatten += walked > mDecode ? walked - mDecode : 0;
+      mPhases.decode += mDecode;
+      mDecode = 0;
+      {
+        ScopedTimer timer(mPhases.verify);
+        boost::string_ref keys(mKeys);
+        boost::string_ref values(mValues);
+        for (const auto& entry : mEntries) {
+          mSink(keys.substr(entry.keyOffset, entry.keyLength), boost::make_optional(
+              entry.value ? boost::string_ref(*entry.value) : values.substr(entry.valueOffset, entry.valueLength)));
+        }
+      }
+      mEntries.clear();
+      mKeys.clear();
+      mValues.clear();
+      mStart = Clock::now();
+    }
+
+    PhaseTimes& mPhases;
+    const ParameterSink& mSink;
+    std::vector<Entry> mEntries;
+    std::string mKeys; ///< Full paths of the batch
+    std::string mValues; ///< Values of the batch that are not strings in the tree, converted
+    uint64_t mDecode; ///< Time spent converting values since the last flush
+    uint64_t mStart; ///< Start of the walk since the last flush
+};
+
+constexpr size_t TreeWalker::BATCH_SIZE;
+
+void getParametersFromServerRecursive(Configuration::ConfigurationInterface* configuration, std::string key,
+    RequestLatency& latency, PhaseTimes& phases, const ParameterSink& sink)
+{
+  auto node = getTreeFromServer(configuration, key, latency);
+  phases.trees++;
+  TreeWalker(phases, sink).walk(node, key);
 }
 
 // Abstract base class for handling different parameter structures: how to put them, get them and check the results
@@ -380,46 +992,233 @@ class ParameterHandler
     {
     }
 
-    virtual void put(Configuration::ConfigurationInterface* configuration, int nParameters)
+    /// Generates the expected parameters. Must be called once before get(), and before forking, so the processes
+    /// share them copy-on-write instead of each generating their own.
+    void prepare(int nParameters)
+    {
+      use(std::make_shared<const ParameterSet>(createParameterSet(nParameters)));
+    }
+
+    /// Uses parameters generated by another handler of the same structure, so threads share them
+    void use(std::shared_ptr<const ParameterSet> parameters)
+    {
+      generated = std::move(parameters);
+      setGenerator(std::make_unique<StoredParameterGenerator>(generated));
+    }
+
+    /// Alternative to prepare() that generates the parameters on demand instead
+    /// \return False if the structure does not support it, then prepare() must be used
+    bool prepareLazy(int nParameters)
+    {
+      auto generator = createLazyGenerator(nParameters);
+      if (!generator) {
+        return false;
+      }
+      setGenerator(std::move(generator));
+      return true;
+    }
+
+    /// Digests the expected parameters, so check() compares digests first
+    /// \return False if the structure does not support it
+    bool prepareDigest(int nParameters)
+    {
+      auto path = treePath(nParameters);
+      if (path.empty()) {
+        return false;
+      }
+      treeDigest = std::make_shared<const TreeDigest>(*parameters, path);
+      return true;
+    }
+
+    /// Gets the parameters from the server. May be called repeatedly with the same configuration.
+    /// With streamCheck, checks them as they arrive instead of keeping them in returnedMap.
+    /// With a treeDigest, keeps the returned tree in returnedTree instead.
+    void get(Configuration::ConfigurationInterface* configuration, int nParameters)
+    {
+      returnedMap.clear();
+      if (treeDigest) {
+        auto node = getTreeFromServer(configuration, treeDigest->root(), requestLatency);
+        if (streamCheck) {
+          ScopedTimer timer(phaseTimes.verify);
+          streamedMismatches += compareTree(node);
+        } else {
+          returnedTree = std::move(node);
+        }
+        return;
+      }
+
+      failedKeys.clear();
+      if (!streamCheck) {
+        fetch(configuration, nParameters, [&](boost::string_ref key, boost::optional<boost::string_ref> value) {
+          if (value) {
+            returnedMap[key.to_string()] = value->to_string();
+          } else {
+            failedKeys.push_back(key.to_string());
+          }
+        });
+        return;
+      }
+
+      Verifier verifier(verificationIndex.get(), *parameters, logMismatch);
+      fetch(configuration, nParameters, [&](boost::string_ref key, boost::optional<boost::string_ref> value) {
+        if (value) {
+          verifier.check(key, *value);
+        } else {
+          verifier.fail(key);
+        }
+      });
+      streamedMismatches += finishCheck(verifier);
+    }
+
+    /// \return Mismatches of the last get, or with streamCheck, the sum of the mismatches of all gets
+    int check()
+    {
+      if (streamCheck) {
+        return streamedMismatches;
+      }
+      if (treeDigest) {
+        return compareTree(returnedTree);
+      }
+
+      Verifier verifier(verificationIndex.get(), *parameters, logMismatch);
+      for (const auto& kv : returnedMap) {
+        verifier.check(kv.first, kv.second);
+      }
+      for (const auto& key : failedKeys) {
+        verifier.fail(key);
+      }
+      return finishCheck(verifier);
+    }
+
+    virtual ParameterSet createParameterSet(int nParameters) = 0;
+
+    std::shared_ptr<const ParameterSet> generated; ///< Stored parameters, null if they are generated on demand
+    std::unique_ptr<ParameterGenerator> parameters; ///< Gives the expected parameters, set by prepare()
+    std::shared_ptr<const VerificationIndex> verificationIndex; ///< Index of the stored parameters, if checked
+    std::shared_ptr<const TreeDigest> treeDigest; ///< Digests of the stored parameters, if checked by digest
+    std::shared_ptr<const KeyDistribution> keyDistribution; ///< Picks the keys of single-key requests
+    ParameterMap returnedMap; ///< Returned parameters of the last get, empty with streamCheck or treeDigest
+    Configuration::Tree::Node returnedTree; ///< Returned tree of the last get with treeDigest but not streamCheck
+    std::vector<std::string> divergedSubtrees; ///< Deepest differing directories found by the last digest check
+    RequestLatency requestLatency;
+    PhaseTimes phaseTimes;
+    bool streamCheck = false; ///< Check the parameters of every get while getting them
+    int streamedMismatches = 0;
+    std::vector<std::string> failedKeys; ///< Keys of the last get whose request failed, empty with streamCheck
+
+  protected:
+    /// Requests the parameters and passes them to the sink
+    virtual void fetch(Configuration::ConfigurationInterface* configuration, int, const ParameterSink& sink)
+    {
+      getParametersFromServer(configuration, *parameters, requestLatency, phaseTimes, sink);
+    }
+
+    /// \return Mismatches of a get, once all its parameters were checked. The parameters of failed requests are
+    ///   errors, not mismatches.
+    virtual int finishCheck(Verifier& verifier)
     {
-      auto parameterMap = createParameterMap(nParameters);
-      putParametersToServer(configuration, parameterMap);
+      if (verifier.returned() + verifier.failed() != parameters->size()) {
+        log() << "Mismatch of size"
+            << " generated:" << parameters->size()
+            << " returned:" << verifier.returned() << '\n';
+      }
+      return verifier.finish();
     }
 
-    virtual void get(Configuration::ConfigurationInterface* configuration, int nParameters)
+    virtual void setGenerator(std::unique_ptr<ParameterGenerator> generator)
     {
-      generatedMap = createParameterMap(nParameters);
-      returnedMap = getParametersFromServer(configuration, generatedMap);
+      parameters = std::move(generator);
     }
 
-    virtual int check()
+    /// \return Generator of the parameters on demand, or nullptr if the structure does not support it
+    virtual auto createLazyGenerator(int) -> std::unique_ptr<ParameterGenerator>
     {
-      return checkReturnedParameters(generatedMap, returnedMap);
+      return nullptr;
     }
 
-    virtual ParameterMap createParameterMap(int nParameters) = 0;
+    /// \return Path of the directory holding all parameters, or an empty string if the structure has none
+    virtual std::string treePath(int)
+    {
+      return "";
+    }
 
-    ParameterMap generatedMap;
-    ParameterMap returnedMap;
+  private:
+    /// Compares the digests of a returned tree, and the parameters of the differing directories
+    int compareTree(const Configuration::Tree::Node& node)
+    {
+      Verifier verifier(verificationIndex.get(), *parameters, logMismatch);
+      divergedSubtrees = treeDigest->compare(node, verifier);
+      return finishCheck(verifier);
+    }
 };
 
-/// One query per parameter
+/// One query per parameter. Which keys are requested follows the key distribution.
 class SeparateParameterHandler: public ParameterHandler
 {
+  public:
+    SeparateParameterHandler()
+        : mGenerator(uint64_t(::getpid()) ^ Clock::now())
+    {
+    }
+
+  protected:
+    /// With a random key distribution, does as many requests as there are parameters, for the drawn keys
+    virtual void fetch(Configuration::ConfigurationInterface* configuration, int nParameters,
+        const ParameterSink& sink)
+    {
+      if (keyDistribution->isSequential()) {
+        ParameterHandler::fetch(configuration, nParameters, sink);
+        return;
+      }
+
+      if (auto sharded = dynamic_cast<ShardedConfiguration*>(configuration)) {
+        getParametersFromShards(*sharded, parameters->size(), [&](size_t i) {
+          return parameters->get(keyDistribution->pick(i, mGenerator)).key;
+        }, requestLatency, phaseTimes, sink);
+        return;
+      }
+
+      log() << "Getting keys: \n";
+      std::string key;
+      for (size_t i = 0; i < parameters->size(); ++i) {
+        auto drawn = parameters->get(keyDistribution->pick(i, mGenerator)).key;
+        key.assign(drawn.data(), drawn.size());
+        auto value = getParameterFromServer(configuration, key, requestLatency);
+        ScopedTimer timer(phaseTimes.verify);
+        sink(key, value ? boost::make_optional(boost::string_ref(*value)) : boost::none);
+      }
+    }
+
+    /// With a random key distribution, only the drawn keys are checked
+    virtual int finishCheck(Verifier& verifier)
+    {
+      if (keyDistribution->isSequential()) {
+        return ParameterHandler::finishCheck(verifier);
+      }
+      return verifier.mismatches() + verifier.unexpected();
+    }
+
+    virtual auto createLazyGenerator(int nParameters) -> std::unique_ptr<ParameterGenerator>
+    {
+      return std::make_unique<NumberedParameterGenerator>(SEPARATE_KEY_PREFIX, nParameters, sValueGenerator);
+    }
+
   private:
-    virtual ParameterMap createParameterMap(int nParameters)
+    virtual ParameterSet createParameterSet(int nParameters)
     {
-      return createParameterMapSeparate(nParameters);
+      return createParameterSetSeparate(nParameters);
     }
+
+    std::mt19937_64 mGenerator;
 };
 
 /// One query per process, parameters combined into one string
 class CombinedParameterHandler: public ParameterHandler
 {
   public:
-    virtual ParameterMap createParameterMap(int nParameters)
+    virtual ParameterSet createParameterSet(int nParameters)
     {
-      return createParameterMapCombined(nParameters);
+      return createParameterSetCombined(nParameters);
     }
 };
 
@@ -427,15 +1226,27 @@ class CombinedParameterHandler: public ParameterHandler
 class FlatParameterHandler: public ParameterHandler
 {
   public:
-    virtual void get(Configuration::ConfigurationInterface* configuration, int nParameters)
+    virtual ParameterSet createParameterSet(int nParameters)
+    {
+      return createParameterSetFlat(nParameters);
+    }
+
+  protected:
+    virtual void fetch(Configuration::ConfigurationInterface* configuration, int nParameters,
+        const ParameterSink& sink)
+    {
+      getParametersFromServerRecursive(configuration, flatParameterPath(nParameters), requestLatency, phaseTimes,
+          sink);
+    }
+
+    virtual std::string treePath(int nParameters)
     {
-      generatedMap = createParameterMap(nParameters);
-      returnedMap = getParametersFromServerRecursive(configuration, flatParameterPath(nParameters));
+      return flatParameterPath(nParameters);
     }
 
-    virtual ParameterMap createParameterMap(int nParameters)
+    virtual auto createLazyGenerator(int nParameters) -> std::unique_ptr<ParameterGenerator>
     {
-      return createParameterMapFlat(nParameters);
+      return std::make_unique<NumberedParameterGenerator>(flatKeyPrefix(nParameters), nParameters, sValueGenerator);
     }
 };
 
@@ -443,19 +1254,35 @@ class FlatParameterHandler: public ParameterHandler
 class TreeParameterHandler: public ParameterHandler
 {
   public:
-    virtual void get(Configuration::ConfigurationInterface* configuration, int nParameters)
+    explicit TreeParameterHandler(const TreeShape& shape)
+        : mShape(shape)
+    {
+    }
+
+    virtual ParameterSet createParameterSet(int nParameters)
+    {
+      return createParameterSetTree(nParameters, mShape);
+    }
+
+  protected:
+    virtual void fetch(Configuration::ConfigurationInterface* configuration, int nParameters,
+        const ParameterSink& sink)
     {
-      generatedMap = createParameterMap(nParameters);
-      returnedMap = getParametersFromServerRecursive(configuration, treeParameterPath(nParameters));
+      getParametersFromServerRecursive(configuration, treeParameterPath(nParameters), requestLatency, phaseTimes,
+          sink);
     }
 
-    virtual ParameterMap createParameterMap(int nParameters)
+    virtual std::string treePath(int nParameters)
     {
-      return createParameterMapTree(nParameters);
+      return treeParameterPath(nParameters);
     }
+
+  private:
+    TreeShape mShape;
 };
 
-std::string selectUri(const Options& options)
+/// \param seed Value used to pick a server, the PID of the process plus the index of the thread, if any
+std::string selectUri(const Options& options, int seed)
 {
     if (options.serverUris.empty()) {
       throw std::runtime_error("No server URIs specified");
@@ -463,39 +1290,124 @@ std::string selectUri(const Options& options)
       log() << "Server URI: " << options.serverUris.at(0) << '\n';
       return options.serverUris.at(0);
     } else {
-      auto pid = ::getpid();
-      const auto& serverUri = options.serverUris.at(pid % options.serverUris.size());
-      log() << "Used PID " << pid << " to select 'round-robin' server URI: " << serverUri << '\n';
+      const auto& serverUri = options.serverUris.at(seed % options.serverUris.size());
+      log() << "Used PID " << seed << " to select server URI: " << serverUri << '\n';
       return serverUri;
     }
 }
 
-auto getParameterHandler(const Options& options) -> std::unique_ptr<ParameterHandler>
+/// Like ConfigurationFactory::getConfiguration(), but also supports the in-process mock backend with "mock://" URIs
+auto getConfiguration(const std::string& uri) -> std::unique_ptr<Configuration::ConfigurationInterface>
 {
-  if (options.parameterStructure == PARAM_MODE_SEPARATE) {
-    return std::make_unique<SeparateParameterHandler>();
-  } else if (options.parameterStructure == PARAM_MODE_COMBINED) {
-    return std::make_unique<CombinedParameterHandler>();
-  } else if (options.parameterStructure == PARAM_MODE_FLAT) {
-    return std::make_unique<FlatParameterHandler>();
-  } else if (options.parameterStructure == PARAM_MODE_TREE) {
-    return std::make_unique<TreeParameterHandler>();
-  } else {
-    throw std::runtime_error("invalid 'mode' option");
+  if (MockConfiguration::isMockUri(uri)) {
+    return std::make_unique<MockConfiguration>(uri);
   }
+  return Configuration::ConfigurationFactory::getConfiguration(uri);
 }
 
-void printMapCsv(const ParameterMap& map)
+/// Configuration for the gets of a client: the server picked by selectUri(), or with a server policy, all servers
+/// behind a ReplicatedConfiguration with that one as primary, or when sharded, all servers behind a
+/// ShardedConfiguration
+auto getClientConfiguration(const Options& options, const std::string& uri, int seed)
+    -> std::unique_ptr<Configuration::ConfigurationInterface>
 {
-  for (auto& kv : map) {
-    log() << kv.first << "," << kv.second << "\n";
+  if (options.sharded) {
+    log() << "Sharding keys over " << options.serverUris.size() << " servers\n";
+    return std::make_unique<ShardedConfiguration>(options.serverUris, getConfiguration);
   }
+  if (options.serverPolicy == SERVER_POLICY_PID || options.serverUris.size() < 2) {
+    return getConfiguration(uri);
+  }
+
+  auto policy = options.serverPolicy == SERVER_POLICY_TWO_CHOICES ? ReplicatedConfiguration::Policy::TwoChoices
+      : options.serverPolicy == SERVER_POLICY_HEDGED ? ReplicatedConfiguration::Policy::Hedged
+      : ReplicatedConfiguration::Policy::FanOut;
+  std::vector<std::unique_ptr<Configuration::ConfigurationInterface>> replicas;
+  for (const auto& serverUri : options.serverUris) {
+    replicas.push_back(getConfiguration(serverUri));
+  }
+  log() << "Using server policy '" << options.serverPolicy << "' over " << replicas.size() << " servers\n";
+  return std::make_unique<ReplicatedConfiguration>(std::move(replicas), policy, seed % options.serverUris.size(),
+      options.hedgePercentile);
 }
 
-template <typename T>
-int64_t toMillis(const T& t)
+/// The mock backend lives in this process, so it must be filled before the clients start. When sharded, every store
+/// only gets the keys of its server.
+void fillMockStores(const Options& options, ParameterGenerator& parameters)
 {
-  return std::chrono::duration_cast<std::chrono::milliseconds>(t).count();
+  auto ring = options.sharded ? std::make_unique<ShardRing>(options.serverUris) : nullptr;
+  for (size_t server = 0; server < options.serverUris.size(); ++server) {
+    const auto& uri = options.serverUris[server];
+    if (MockConfiguration::isMockUri(uri)) {
+      log() << "Filling mock store '" << uri << "'\n";
+      auto store = MockConfiguration::getStore(uri);
+      for (size_t i = 0; i < parameters.size(); ++i) {
+        auto parameter = parameters.get(i);
+        if (!ring || ring->shard(parameter.key) == server) {
+          store->put(parameter.key.to_string(), parameter.value.to_string());
+        }
+      }
+    }
+  }
+}
+
+/// Prepares the parameters of the handler, on demand if requested and supported by the structure, and indexes them
+/// for checking
+/// \param shared Handler that already prepared the parameters, to share them instead of generating them again
+void prepareParameters(const Options& options, ParameterHandler& parameterHandler,
+    const ParameterHandler* shared = nullptr)
+{
+  if (options.lazyParameters && parameterHandler.prepareLazy(options.parameterNumber)) {
+    // Generated on demand
+  } else if (shared) {
+    parameterHandler.use(shared->generated);
+    parameterHandler.verificationIndex = shared->verificationIndex;
+    parameterHandler.treeDigest = shared->treeDigest;
+  } else {
+    parameterHandler.prepare(options.parameterNumber);
+    if (!options.skipCheckValues) {
+      parameterHandler.verificationIndex = std::make_shared<const VerificationIndex>(*parameterHandler.parameters);
+      if (options.digestCheck) {
+        parameterHandler.prepareDigest(options.parameterNumber);
+      }
+    }
+  }
+  // Built once like the parameters, as its tables grow with the number of keys
+  parameterHandler.keyDistribution = shared ? shared->keyDistribution
+      : std::make_shared<const KeyDistribution>(options.keyDistribution, parameterHandler.parameters->size());
+}
+
+auto getParameterHandler(const Options& options) -> std::unique_ptr<ParameterHandler>
+{
+  std::unique_ptr<ParameterHandler> parameterHandler;
+  if (options.parameterStructure == PARAM_MODE_SEPARATE) {
+    parameterHandler = std::make_unique<SeparateParameterHandler>();
+  } else if (options.parameterStructure == PARAM_MODE_COMBINED) {
+    parameterHandler = std::make_unique<CombinedParameterHandler>();
+  } else if (options.parameterStructure == PARAM_MODE_FLAT) {
+    parameterHandler = std::make_unique<FlatParameterHandler>();
+  } else if (options.parameterStructure == PARAM_MODE_TREE) {
+    parameterHandler = std::make_unique<TreeParameterHandler>(options.treeShape);
+  } else {
+    throw std::runtime_error("invalid 'mode' option");
+  }
+  parameterHandler->streamCheck = options.streamCheck && !options.skipCheckValues;
+  return parameterHandler;
+}
+
+void printMapCsv(const ParameterMap& map)
+{
+  for (auto& kv : map) {
+    log() << kv.first << "," << kv.second << "\n";
+  }
+}
+
+void printMapCsv(ParameterGenerator& parameters)
+{
+  for (size_t i = 0; i < parameters.size(); ++i) {
+    auto parameter = parameters.get(i);
+    log() << parameter.key << "," << parameter.value << "\n";
+  }
 }
 
 template <typename T>
@@ -504,6 +1416,449 @@ double timeToDouble(const T& t)
   return std::chrono::duration<double>(t).count();
 }
 
+/// Sends the percentiles of the histogram as separate metrics, named "[name].p50", "[name].p99", etc.
+void sendHistogram(const Histogram& histogram, const std::string& name, const std::vector<Monitoring::Tag>& tags)
+{
+  auto& monitoring = Monitoring::MonitoringFactory::Get();
+  monitoring.sendTagged<uint64_t>(histogram.count(), name + ".count", std::vector<Monitoring::Tag>(tags));
+  monitoring.sendTagged<uint64_t>(histogram.percentile(50.0), name + ".p50", std::vector<Monitoring::Tag>(tags));
+  monitoring.sendTagged<uint64_t>(histogram.percentile(90.0), name + ".p90", std::vector<Monitoring::Tag>(tags));
+  monitoring.sendTagged<uint64_t>(histogram.percentile(99.0), name + ".p99", std::vector<Monitoring::Tag>(tags));
+  monitoring.sendTagged<uint64_t>(histogram.percentile(99.9), name + ".p999", std::vector<Monitoring::Tag>(tags));
+  monitoring.sendTagged<uint64_t>(histogram.max(), name + ".max", std::vector<Monitoring::Tag>(tags));
+}
+
+void printHistogram(const Histogram& histogram, const std::string& name)
+{
+  log() << name << " [ns]:"
+      << " count=" << histogram.count()
+      << " p50=" << histogram.percentile(50.0)
+      << " p90=" << histogram.percentile(90.0)
+      << " p99=" << histogram.percentile(99.0)
+      << " p99.9=" << histogram.percentile(99.9)
+      << " max=" << histogram.max() << '\n';
+}
+
+/// Results of the gets of a single process
+struct GetResult
+{
+    uint64_t startWallTime = 0; ///< Wall-clock start of the measured gets
+    uint64_t lastStartWallTime = 0; ///< Same as startWallTime, but the latest one when merged
+    uint64_t endWallTime = 0; ///< Wall-clock end of the measured gets
+    uint64_t coldDuration = 0; ///< Duration of the first get, which includes connection setup and cold caches
+    uint64_t duration = 0; ///< Total duration of the measured gets
+    uint64_t iterations = 0; ///< Number of measured gets, or requests in open-loop mode
+    uint64_t errors = 0; ///< Failed requests of the measured gets, and failed writes in open-loop mode
+    uint64_t writes = 0; ///< Writes of the mixed workload, not included in the other counts and latencies
+    uint64_t notifications = 0; ///< Updates observed in watch mode
+    uint64_t missedUpdates = 0; ///< Updates in watch mode that were overwritten before they were observed
+    int mismatches = 0; ///< Returned values that differ from the expected ones
+    Histogram requestLatency; ///< Latencies of the measured requests
+    Histogram coldLatency; ///< Request latencies of the first get
+    Histogram iterationLatency; ///< Durations of the measured gets, including the checks with streaming checks
+    Histogram transferLatency; ///< Time of every measured get spent waiting for the backend
+    Histogram connectLatency; ///< Creating the configuration, which sets up the connection to the server
+    Histogram flattenLatency; ///< Time of every measured get spent flattening returned trees
+    Histogram decodeLatency; ///< Time of every measured get spent converting values of returned trees to strings
+    Histogram verifyLatency; ///< Time of every measured get spent handing the returned parameters to the check
+    Histogram serviceLatency; ///< Latencies from the actual send time in open-loop mode
+    Histogram startLateness; ///< How late the clients were released by the start barrier
+    Histogram writeLatency; ///< Latencies of the writes of the mixed workload, from the intended time in open-loop
+    Histogram propagationLatency; ///< Delays from the writes to their observation in watch mode
+    uint64_t policyGets = 0; ///< Requests made through a server policy
+    uint64_t policySent = 0; ///< Requests the server policy sent to the servers for them
+    Histogram primaryLatency; ///< Latencies the requests had on the server picked by PID, with policies that use it
+
+    /// Fraction of requests the server policy sent on top of the ones made
+    double extraLoad() const
+    {
+      return policyGets == 0 ? 0.0 : double(policySent) / double(policyGets) - 1.0;
+    }
+
+    /// Writes per second during the measured gets
+    double writeThroughput() const
+    {
+      return duration == 0 ? 0.0 : double(writes) / (double(duration) / 1e9);
+    }
+
+    /// Requests per second during the measured gets
+    double throughput() const
+    {
+      return duration == 0 ? 0.0 : double(requestLatency.count()) / (double(duration) / 1e9);
+    }
+
+    /// Combines the results of concurrent workers. The cold-start duration becomes the worst one, and the duration
+    /// becomes the longest one, so throughput() gives the aggregate throughput.
+    void merge(const GetResult& other)
+    {
+      startWallTime = startWallTime == 0 ? other.startWallTime : std::min(startWallTime, other.startWallTime);
+      lastStartWallTime = std::max(lastStartWallTime, other.lastStartWallTime);
+      endWallTime = std::max(endWallTime, other.endWallTime);
+      coldDuration = std::max(coldDuration, other.coldDuration);
+      duration = std::max(duration, other.duration);
+      iterations += other.iterations;
+      errors += other.errors;
+      writes += other.writes;
+      notifications += other.notifications;
+      missedUpdates += other.missedUpdates;
+      mismatches += other.mismatches;
+      requestLatency.merge(other.requestLatency);
+      coldLatency.merge(other.coldLatency);
+      iterationLatency.merge(other.iterationLatency);
+      transferLatency.merge(other.transferLatency);
+      connectLatency.merge(other.connectLatency);
+      flattenLatency.merge(other.flattenLatency);
+      decodeLatency.merge(other.decodeLatency);
+      verifyLatency.merge(other.verifyLatency);
+      serviceLatency.merge(other.serviceLatency);
+      startLateness.merge(other.startLateness);
+      writeLatency.merge(other.writeLatency);
+      propagationLatency.merge(other.propagationLatency);
+      policyGets += other.policyGets;
+      policySent += other.policySent;
+      primaryLatency.merge(other.primaryLatency);
+    }
+};
+
+static_assert(std::is_trivially_copyable<GetResult>::value, "GetResult is copied into shared memory");
+
+/// Result slots in memory shared between forked processes, so the parent can aggregate the results of its children.
+/// Must be created before forking. Every process only writes to its own slot and then publishes it by setting its
+/// ready flag, so no locking is needed.
+class SharedResults
+{
+  public:
+    explicit SharedResults(int slots)
+        : mMemory(sizeof(Slot) * slots), mSlots(static_cast<Slot*>(mMemory.get())), mSlotCount(slots)
+    {
+      for (int i = 0; i < mSlotCount; ++i) {
+        new (&mSlots[i]) Slot();
+      }
+    }
+
+    void publish(int slot, const GetResult& result)
+    {
+      mSlots[slot].result = result;
+      mSlots[slot].ready.store(true, std::memory_order_release);
+    }
+
+    /// Returns the result in the slot, or nullptr if it was never published
+    const GetResult* get(int slot) const
+    {
+      return mSlots[slot].ready.load(std::memory_order_acquire) ? &mSlots[slot].result : nullptr;
+    }
+
+    int size() const
+    {
+      return mSlotCount;
+    }
+
+  private:
+    struct Slot
+    {
+        std::atomic<bool> ready {false};
+        GetResult result;
+    };
+
+    static_assert(ATOMIC_BOOL_LOCK_FREE == 2, "Shared memory atomics must be lock-free");
+
+    SharedMemory mMemory;
+    Slot* mSlots;
+    int mSlotCount;
+};
+
+/// Does a single get. The numbers of the first get of the process are kept as cold-start numbers.
+uint64_t timedGet(const Options& options, ParameterHandler& parameterHandler,
+    Configuration::ConfigurationInterface* configuration, GetResult& result)
+{
+  auto transferred = parameterHandler.requestLatency.totalNanoseconds;
+  auto failures = parameterHandler.requestLatency.failures;
+  auto phases = parameterHandler.phaseTimes;
+  auto start = Clock::now();
+  parameterHandler.get(configuration, options.parameterNumber);
+  auto duration = Clock::since(start);
+  const auto& after = parameterHandler.phaseTimes;
+  result.transferLatency.record(parameterHandler.requestLatency.totalNanoseconds - transferred);
+  result.errors += parameterHandler.requestLatency.failures - failures;
+  result.verifyLatency.record(after.verify - phases.verify);
+  if (after.trees > phases.trees) {
+    result.flattenLatency.record(after.flatten - phases.flatten);
+    result.decodeLatency.record(after.decode - phases.decode);
+  }
+  if (result.coldLatency.count() == 0) {
+    result.coldDuration = duration;
+    result.coldLatency = parameterHandler.requestLatency.histogram;
+  }
+  return duration;
+}
+
+/// Does the warmup gets, at least the cold get, so it never counts as a measured get. Their request latencies are
+/// discarded, except for the cold-start numbers.
+void runWarmup(const Options& options, ParameterHandler& parameterHandler,
+    Configuration::ConfigurationInterface* configuration, GetResult& result)
+{
+  for (int i = 0; i < std::max(1, options.warmupIterations); ++i) {
+    timedGet(options, parameterHandler, configuration, result);
+  }
+  parameterHandler.requestLatency.reset();
+  parameterHandler.streamedMismatches = 0;
+  result.errors = 0;
+  result.transferLatency.reset();
+  result.flattenLatency.reset();
+  result.decodeLatency.reset();
+  result.verifyLatency.reset();
+  if (auto replicated = dynamic_cast<ReplicatedConfiguration*>(configuration)) {
+    replicated->resetStatistics();
+  }
+}
+
+/// Writes a parameter of the mixed workload. The expected value is put back, so the checks of concurrent readers
+/// still hold, while the backend still has to commit the write.
+void writeParameter(Configuration::ConfigurationInterface* configuration, const Parameter& parameter)
+{
+  configuration->putString(parameter.key.to_string(), parameter.value.to_string());
+}
+
+/// Closed-loop: does the warmup gets followed by the measured gets back-to-back, all with the same configuration.
+/// With a mixed workload, writes of single parameters are interleaved with the gets.
+GetResult runClosedLoop(const Options& options, ParameterHandler& parameterHandler,
+    Configuration::ConfigurationInterface* configuration)
+{
+  GetResult result;
+  runWarmup(options, parameterHandler, configuration, result);
+
+  auto& parameters = *parameterHandler.parameters;
+  std::mt19937_64 generator(uint64_t(::getpid()) ^ Clock::now());
+  std::bernoulli_distribution isWrite(options.writeFraction);
+  std::uniform_int_distribution<size_t> writeIndex(0, parameters.size() - 1);
+
+  auto measuredNanoseconds = uint64_t(options.duration * 1e9);
+  result.startWallTime = Clock::wallNow();
+  auto startTime = Clock::now();
+  for (;;) {
+    if (options.writeFraction > 0 && isWrite(generator)) {
+      auto writeStart = Clock::now();
+      writeParameter(configuration, parameters.get(writeIndex(generator)));
+      result.writeLatency.record(Clock::since(writeStart));
+      result.writes++;
+    } else {
+      result.iterationLatency.record(timedGet(options, parameterHandler, configuration, result));
+      result.iterations++;
+    }
+
+    if (options.duration > 0) {
+      if (Clock::since(startTime) >= measuredNanoseconds) {
+        break;
+      }
+    } else if (result.iterations >= uint64_t(options.iterations)) {
+      break;
+    }
+  }
+  result.duration = Clock::since(startTime);
+  result.endWallTime = Clock::wallNow();
+  return result;
+}
+
+/// Open-loop: after the warmup gets, issues getString() requests for the parameter keys according to a schedule with
+/// the process's share of the target rate, regardless of how long earlier requests took. The keys follow the key
+/// distribution.
+///
+/// Latency is measured from the intended send time. A request stalled by the server also delays the ones scheduled
+/// behind it, and that wait counts towards their latency, which corrects for coordinated omission. The latency from
+/// the actual send time is kept separately as the service latency.
+///
+/// With a mixed workload, requests are writes of the parameter instead with the configured probability.
+GetResult runOpenLoop(const Options& options, ParameterHandler& parameterHandler,
+    Configuration::ConfigurationInterface* configuration)
+{
+  GetResult result;
+  runWarmup(options, parameterHandler, configuration, result);
+
+  auto& parameters = *parameterHandler.parameters;
+
+  double rate = options.rate / options.processNumber;
+  uint64_t requests = options.duration > 0
+      ? uint64_t(options.duration * rate)
+      : uint64_t(options.iterations) * parameters.size();
+  log() << "Open-loop: " << requests << " requests at " << rate << " requests/s, " << options.arrivals
+      << " arrivals\n";
+
+  std::mt19937_64 generator(uint64_t(::getpid()) ^ Clock::now());
+  std::exponential_distribution<double> interval(rate);
+  std::bernoulli_distribution isWrite(options.writeFraction);
+  const auto& keyDistribution = *parameterHandler.keyDistribution;
+  bool poisson = options.arrivals == ARRIVALS_POISSON;
+
+  std::string key;
+  result.startWallTime = Clock::wallNow();
+  auto startTime = Clock::now();
+  double scheduleOffset = 0; // Nanoseconds after the start time, kept as double to not accumulate rounding errors
+  for (uint64_t i = 0; i < requests; ++i) {
+    auto parameter = parameters.get(keyDistribution.pick(i, generator));
+    key.assign(parameter.key.data(), parameter.key.size());
+    auto intendedTime = startTime + uint64_t(scheduleOffset);
+    Clock::sleepUntil(intendedTime);
+    scheduleOffset += poisson ? interval(generator) * 1e9 : 1e9 / rate;
+
+    if (options.writeFraction > 0 && isWrite(generator)) {
+      try {
+        writeParameter(configuration, parameter);
+      } catch (const std::exception&) {
+        result.errors++;
+      }
+      result.writeLatency.record(Clock::since(intendedTime));
+      result.writes++;
+      continue;
+    }
+
+    auto sendTime = Clock::now();
+    auto value = configuration->getString(key);
+    auto endTime = Clock::now();
+
+    parameterHandler.requestLatency.record(key, Clock::elapsed(intendedTime, endTime));
+    result.serviceLatency.record(Clock::elapsed(sendTime, endTime));
+    if (!value) {
+      result.errors++;
+    } else if (boost::string_ref(*value) != parameter.value) {
+      result.mismatches++;
+    }
+  }
+  result.iterations = requests - result.writes;
+  result.duration = Clock::since(startTime);
+  result.endWallTime = Clock::wallNow();
+  return result;
+}
+
+std::string watchKey(int n)
+{
+  return WATCH_PATH + "/key" + std::to_string(n);
+}
+
+/// Watch values carry the sequence number of the update, the total number of updates, and the wall-clock time of the
+/// write in nanoseconds
+std::string makeWatchValue(uint64_t sequence, uint64_t total, uint64_t wallTime)
+{
+  return std::to_string(sequence) + ' ' + std::to_string(total) + ' ' + std::to_string(wallTime);
+}
+
+bool parseWatchValue(const std::string& value, uint64_t& sequence, uint64_t& total, uint64_t& wallTime)
+{
+  unsigned long long parts[3];
+  if (std::sscanf(value.c_str(), "%llu %llu %llu", &parts[0], &parts[1], &parts[2]) != 3) {
+    return false;
+  }
+  sequence = parts[0];
+  total = parts[1];
+  wallTime = parts[2];
+  return true;
+}
+
+/// Creates the watched keys, so the subtree exists before the watchers start
+void initializeWatchKeys(const Options& options)
+{
+  auto configuration = getConfiguration(options.serverUris.at(0));
+  for (int i = 0; i < options.watchKeys; ++i) {
+    configuration->putString(watchKey(i), "initial");
+  }
+}
+
+/// Writes the updates of the watch benchmark to the first server, which the watched servers must replicate, starting
+/// one interval after the watchers were released by the start barrier, which gives them time to get the initial
+/// key-values
+void runWatchWriter(const Options& options, StartBarrier& startBarrier)
+{
+  auto configuration = getConfiguration(options.serverUris.at(0));
+  startBarrier.arriveAndWait();
+  auto begin = Clock::now();
+  auto interval = options.watchInterval * 1e9;
+
+  Histogram latency;
+  for (int i = 0; i < options.watchWrites; ++i) {
+    Clock::sleepUntil(begin + uint64_t((i + 1) * interval));
+    auto start = Clock::now();
+    configuration->putString(watchKey(i % options.watchKeys), makeWatchValue(i, options.watchWrites,
+        Clock::wallNow()));
+    latency.record(Clock::since(start));
+  }
+  log() << "Watch writer: " << options.watchWrites << " updates\n";
+  printHistogram(latency, "Watch write latency");
+}
+
+/// Runs the watch writer in a thread. It is an extra party of the start barrier.
+/// \param error Set to the exception of the writer, if any, once the thread was joined
+std::thread startWatchWriter(const Options& options, StartBarrier& startBarrier, std::exception_ptr& error)
+{
+  bool verbose = sVerbose;
+  return std::thread([&options, &startBarrier, &error, verbose]{
+    sVerbose = verbose;
+    try {
+      runWatchWriter(options, startBarrier);
+    } catch (...) {
+      error = std::current_exception();
+    }
+  });
+}
+
+/// Watches the subtree until the last update was observed or the timeout passed, recording the delay from the write
+/// of every observed update to its observation. The key-values present when the watch starts are not measured.
+GetResult runWatcher(const Options& options, const std::string& uri)
+{
+  GetResult result;
+  auto watcher = Watcher::create(uri, WATCH_PATH, [&]{ return getConfiguration(uri); },
+      uint64_t(options.watchPollInterval * 1e9));
+  log() << "Watching '" << WATCH_PATH << "' using " << watcher->mechanism() << '\n';
+
+  auto timeout = uint64_t((options.duration > 0 ? options.duration : DEFAULT_WATCH_TIMEOUT) * 1e9);
+  std::map<std::string, uint64_t> lastSequences;
+  uint64_t firstSequence = std::numeric_limits<uint64_t>::max();
+  uint64_t lastSequence = 0;
+  bool baseline = true;
+  bool done = false;
+
+  result.startWallTime = Clock::wallNow();
+  auto startTime = Clock::now();
+  while (!done) {
+    auto elapsed = Clock::since(startTime);
+    if (elapsed >= timeout) {
+      break;
+    }
+    auto keyValues = watcher->wait(timeout - elapsed);
+    auto observedWallTime = Clock::wallNow();
+    if (!keyValues) {
+      break;
+    }
+
+    for (const auto& kv : *keyValues) {
+      uint64_t sequence, total, wallTime;
+      if (!parseWatchValue(kv.second, sequence, total, wallTime)) {
+        continue;
+      }
+      auto last = lastSequences.find(kv.first);
+      if (last != lastSequences.end() && sequence <= last->second) {
+        continue;
+      }
+      lastSequences[kv.first] = sequence;
+      if (baseline) {
+        continue;
+      }
+
+      result.propagationLatency.record(observedWallTime > wallTime ? observedWallTime - wallTime : 0);
+      result.notifications++;
+      firstSequence = std::min(firstSequence, sequence);
+      lastSequence = std::max(lastSequence, sequence);
+      done = done || (sequence + 1 == total);
+    }
+    baseline = false;
+  }
+
+  if (result.notifications > 0) {
+    result.missedUpdates = (lastSequence - firstSequence + 1) - result.notifications;
+  }
+  result.duration = Clock::since(startTime);
+  result.endWallTime = Clock::wallNow();
+  return result;
+}
+
 void configureMonitoring(const Options& options)
 {
 //      auto conf = Configuration::ConfigurationFactory::getConfiguration(uri);
@@ -511,6 +1866,232 @@ void configureMonitoring(const Options& options)
   Monitoring::MonitoringFactory::Configure(options.monitoringConfigUri);
 }
 
+void printResult(const GetResult& result)
+{
+  if (result.lastStartWallTime > result.startWallTime) {
+    log() << "Start spread: " << (result.lastStartWallTime - result.startWallTime) << " ns\n";
+  }
+  log() << "Cold get: " << result.coldDuration << " ns\n";
+  printHistogram(result.coldLatency, "Cold request latency");
+  log() << "Measured gets: " << result.iterations << " in " << result.duration << " ns, "
+      << result.throughput() << " requests/s\n";
+  printHistogram(result.iterationLatency, "Get latency");
+  printHistogram(result.transferLatency, "Transfer latency");
+  printHistogram(result.requestLatency, "Request latency");
+  if (result.connectLatency.count() > 0) {
+    printHistogram(result.connectLatency, "Connect latency");
+  }
+  if (result.flattenLatency.count() > 0) {
+    printHistogram(result.flattenLatency, "Flatten latency");
+    printHistogram(result.decodeLatency, "Decode latency");
+  }
+  if (result.verifyLatency.count() > 0) {
+    printHistogram(result.verifyLatency, "Verify latency");
+  }
+  printHistogram(result.startLateness, "Start lateness");
+  if (result.serviceLatency.count() > 0) {
+    printHistogram(result.serviceLatency, "Service latency");
+  }
+  if (result.errors > 0) {
+    log() << "Failed requests: " << result.errors << '\n';
+  }
+  if (result.writes > 0) {
+    log() << "Writes: " << result.writes << ", " << result.writeThroughput() << " writes/s\n";
+    printHistogram(result.writeLatency, "Write latency");
+  }
+  if (result.propagationLatency.count() > 0) {
+    log() << "Observed updates: " << result.notifications << ", missed: " << result.missedUpdates << '\n';
+    printHistogram(result.propagationLatency, "Write-to-observed delay");
+  }
+  if (result.policyGets > 0) {
+    log() << "Server policy: " << result.policySent << " requests sent for " << result.policyGets << ", "
+        << result.extraLoad() * 100.0 << "% extra load\n";
+    if (result.primaryLatency.count() > 0) {
+      printHistogram(result.primaryLatency, "Primary server latency");
+      log() << "Tail improvement over primary server: p99 "
+          << int64_t(result.primaryLatency.percentile(99.0)) - int64_t(result.requestLatency.percentile(99.0))
+          << " ns, p99.9 "
+          << int64_t(result.primaryLatency.percentile(99.9)) - int64_t(result.requestLatency.percentile(99.9))
+          << " ns\n";
+    }
+  }
+}
+
+std::vector<Monitoring::Tag> getTags(const Options& options)
+{
+  std::vector<Monitoring::Tag> tags {
+    {"process.number", std::to_string(options.processNumber)},
+    {"param.number", std::to_string(options.parameterNumber)},
+    {"param.structure", options.parameterStructure},
+  };
+  if (options.writeFraction > 0) {
+    tags.push_back({"read.write.ratio", options.readWriteRatio});
+  }
+  return tags;
+}
+
+/// \param prefix Prefix for the metric names
+void sendResult(const Options& options, const GetResult& result, const std::string& prefix = "")
+{
+  try {
+    auto start = result.startWallTime / 1000000;
+    auto end = result.endWallTime / 1000000;
+
+    const auto tags = getTags(options);
+
+    auto& monitoring = Monitoring::MonitoringFactory::Get();
+    monitoring.sendTagged<uint64_t>(start, prefix + "time", std::vector<Monitoring::Tag>(tags));
+    monitoring.sendTagged<uint64_t>(end, prefix + "time", std::vector<Monitoring::Tag>(tags));
+    monitoring.sendTagged<uint64_t>(result.duration, prefix + "duration", std::vector<Monitoring::Tag>(tags));
+    monitoring.sendTagged<uint64_t>(result.coldDuration, prefix + "duration.cold", std::vector<Monitoring::Tag>(tags));
+    monitoring.sendTagged<double>(result.throughput(), prefix + "throughput", std::vector<Monitoring::Tag>(tags));
+    monitoring.sendTagged<uint64_t>(result.lastStartWallTime - result.startWallTime, prefix + "start.spread",
+        std::vector<Monitoring::Tag>(tags));
+    sendHistogram(result.startLateness, prefix + "start.lateness", tags);
+    if (options.watch) {
+      monitoring.sendTagged<uint64_t>(result.notifications, prefix + "watch.notifications",
+          std::vector<Monitoring::Tag>(tags));
+      monitoring.sendTagged<uint64_t>(result.missedUpdates, prefix + "watch.missed",
+          std::vector<Monitoring::Tag>(tags));
+      sendHistogram(result.propagationLatency, prefix + "watch.latency", tags);
+    } else {
+      sendHistogram(result.requestLatency, prefix + "latency", tags);
+      sendHistogram(result.coldLatency, prefix + "latency.cold", tags);
+      sendHistogram(result.iterationLatency, prefix + "latency.get", tags);
+      sendHistogram(result.transferLatency, prefix + "latency.transfer", tags);
+      sendHistogram(result.connectLatency, prefix + "latency.connect", tags);
+      if (result.flattenLatency.count() > 0) {
+        sendHistogram(result.flattenLatency, prefix + "latency.flatten", tags);
+        sendHistogram(result.decodeLatency, prefix + "latency.decode", tags);
+      }
+      if (result.verifyLatency.count() > 0) {
+        sendHistogram(result.verifyLatency, prefix + "latency.verify", tags);
+      }
+    }
+    if (options.rate > 0) {
+      sendHistogram(result.serviceLatency, prefix + "latency.service", tags);
+      monitoring.sendTagged<uint64_t>(result.errors, prefix + "errors", std::vector<Monitoring::Tag>(tags));
+    }
+    if (options.writeFraction > 0) {
+      monitoring.sendTagged<double>(result.writeThroughput(), prefix + "write.throughput",
+          std::vector<Monitoring::Tag>(tags));
+      sendHistogram(result.writeLatency, prefix + "latency.write", tags);
+    }
+    if (result.policyGets > 0) {
+      monitoring.sendTagged<double>(result.extraLoad(), prefix + "policy.load.extra",
+          std::vector<Monitoring::Tag>(tags));
+      if (result.primaryLatency.count() > 0) {
+        sendHistogram(result.primaryLatency, prefix + "latency.primary", tags);
+      }
+    }
+  }
+  catch (const std::exception& e) {
+    throw std::runtime_error(std::string("Failed to send monitoring data - ") + e.what());
+  }
+
+  if (result.mismatches > 0) {
+    std::cout << "Mismatches found: " << result.mismatches << '\n';
+    Monitoring::MonitoringFactory::Get().sendTagged(result.mismatches, prefix + "mismatches", {});
+  }
+}
+
+/// Results of the puts to a single server
+struct PutResult
+{
+    size_t batchSize = 1; ///< Parameters per put
+    bool nativeBatches = false; ///< If the backend's own batches were used, otherwise individual puts
+    uint64_t duration = 0; ///< Time to put all parameters
+    uint64_t parameters = 0; ///< Number of parameters put
+    Histogram latency; ///< Latency of the individual puts, or of the batches
+
+    /// Parameters per second
+    double throughput() const
+    {
+      return duration > 0 ? double(parameters) / (double(duration) / 1e9) : 0.0;
+    }
+};
+
+/// Puts the parameters to one server, with up to options.putConcurrency puts in flight, each over its own connection
+PutResult putToServer(const Options& options, const std::string& uri, const ParameterSet& parameters,
+    size_t batchSize)
+{
+  std::mutex mutex;
+  PutResult result;
+  result.batchSize = batchSize;
+  result.parameters = parameters.size();
+  std::exception_ptr error;
+  bool verbose = sVerbose;
+  auto batches = (parameters.size() + batchSize - 1) / batchSize;
+  auto connections = std::min<size_t>(options.putConcurrency, std::max<size_t>(batches, 1));
+
+  auto start = Clock::now();
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < connections; ++i) {
+    threads.emplace_back([&, i]{
+      sVerbose = verbose && (connections == 1); // Interleaved key listings would be unreadable
+      try {
+        auto writer = batchSize > 1 ? BatchWriter::create(uri) : nullptr;
+        auto configuration = writer ? nullptr : getConfiguration(uri);
+        Histogram latency;
+        putParametersToServer(configuration.get(), writer.get(), parameters, batchSize, i, connections, latency);
+        std::lock_guard<std::mutex> lock(mutex);
+        result.latency.merge(latency);
+        result.nativeBatches = writer != nullptr;
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(mutex);
+        error = std::current_exception();
+      }
+    });
+  }
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  result.duration = Clock::since(start);
+
+  if (error) {
+    std::rethrow_exception(error);
+  }
+  return result;
+}
+
+void printPutResult(const PutResult& result)
+{
+  log() << "Batch size: " << result.batchSize << (result.nativeBatches ? " (native)" : " (individual puts)") << '\n';
+  log() << "Puts: " << result.parameters << " parameters in " << result.duration << " ns, " << result.throughput()
+      << " parameters/s\n";
+  printHistogram(result.latency, result.batchSize > 1 ? "Batch latency" : "Put latency");
+}
+
+void sendPutResult(const Options& options, const std::string& uri, const PutResult& result)
+{
+  auto tags = getTags(options);
+  tags.push_back({"server.uri", uri});
+  tags.push_back({"put.concurrency", std::to_string(options.putConcurrency)});
+  tags.push_back({"put.batch.size", std::to_string(result.batchSize)});
+  tags.push_back({"put.batch.native", result.nativeBatches ? "true" : "false"});
+
+  auto& monitoring = Monitoring::MonitoringFactory::Get();
+  monitoring.sendTagged<uint64_t>(result.duration, "put.duration", std::vector<Monitoring::Tag>(tags));
+  monitoring.sendTagged<double>(result.throughput(), "put.throughput", std::vector<Monitoring::Tag>(tags));
+  sendHistogram(result.latency, "put.latency", tags);
+}
+
+/// Splits the parameters by the server that owns them
+auto splitByShard(const ParameterSet& parameters, const ShardRing& ring) -> std::vector<ParameterSet>
+{
+  std::vector<ParameterSet> shards(ring.size());
+  for (size_t i = 0; i < parameters.size(); ++i) {
+    shards[ring.shard(parameters.key(i))].add(parameters.key(i), parameters.value(i));
+  }
+  for (auto& shard : shards) {
+    shard.sort();
+  }
+  return shards;
+}
+
+/// Puts the parameters to all servers concurrently, once for every batch size, and reports the put throughput of each.
+/// When sharded, every server only gets the parameters it owns.
 void doPut(const Options& options, ParameterHandler& parameterHandler)
 {
   log() << "Putting '" << options.parameterNumber << "' parameters to servers ";
@@ -519,81 +2100,364 @@ void doPut(const Options& options, ParameterHandler& parameterHandler)
   }
   log() << '\n';
 
-  for (const auto& uri : options.serverUris) {
-    auto configuration = Configuration::ConfigurationFactory::getConfiguration(uri);
-    parameterHandler.put(configuration.get(), options.parameterNumber);
+  // Generated once and shared read-only by all put threads
+  parameterHandler.prepare(options.parameterNumber);
+  const auto& parameters = *parameterHandler.generated;
+  auto shards = options.sharded ? splitByShard(parameters, ShardRing(options.serverUris))
+      : std::vector<ParameterSet>();
+
+  if (!options.monitoringConfigUri.empty()) {
+    configureMonitoring(options);
+  }
+
+  // Indexed by server, then by batch size
+  std::vector<std::vector<PutResult>> results(options.serverUris.size());
+  bool verbose = sVerbose;
+
+  for (auto batchSize : options.putBatchSizes) {
+    std::vector<std::exception_ptr> errors(options.serverUris.size());
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < options.serverUris.size(); ++i) {
+      threads.emplace_back([&, i]{
+        sVerbose = verbose && (options.serverUris.size() == 1);
+        try {
+          const auto& serverParameters = options.sharded ? shards[i] : parameters;
+          results[i].push_back(putToServer(options, options.serverUris[i], serverParameters, batchSize));
+        } catch (...) {
+          errors[i] = std::current_exception();
+        }
+      });
+    }
+
+    for (auto& thread : threads) {
+      thread.join();
+    }
+
+    for (size_t i = 0; i < options.serverUris.size(); ++i) {
+      const auto& uri = options.serverUris[i];
+      if (errors[i]) {
+        try {
+          std::rethrow_exception(errors[i]);
+        } catch (const std::exception& e) {
+          throw std::runtime_error("Failed to put to '" + uri + "' - " + e.what());
+        }
+      }
+
+      log() << "# Puts to '" << uri << "'\n";
+      printPutResult(results[i].back());
+      if (!options.monitoringConfigUri.empty()) {
+        sendPutResult(options, uri, results[i].back());
+      }
+    }
+  }
+
+  if (options.putBatchSizes.size() > 1) {
+    for (size_t i = 0; i < options.serverUris.size(); ++i) {
+      log() << "# Throughput by batch size for '" << options.serverUris[i] << "'\n";
+      for (const auto& result : results[i]) {
+        log() << std::setw(8) << result.batchSize << ' ' << result.throughput() << " parameters/s\n";
+      }
+    }
   }
 }
 
-void doGet(const Options& options, ParameterHandler& parameterHandler) {
-  if (options.processNumber > 1) {
-    log() << "Forking to get " << options.processNumber << " processes\n";
+/// Gets the parameters as a single client, which is either a forked process or a thread
+/// \param seed Value used to pick a server, see selectUri()
+/// \param startBarrier Barrier shared by all clients of the node
+GetResult runWorker(const Options& options, ParameterHandler& parameterHandler, int seed,
+    StartBarrier& startBarrier)
+{
+  log() << "Waiting for start\n";
+  auto lateness = startBarrier.arriveAndWait();
+
+  // Get parameters from server. Sharded clients do not pick one, they use all of them.
+  std::string uri = options.sharded ? std::string() : selectUri(options, seed);
+  if (options.watch) {
+    auto result = runWatcher(options, uri);
+    result.lastStartWallTime = result.startWallTime;
+    result.startLateness.record(lateness);
+    printResult(result);
+    return result;
+  }
+
+  log() << "Getting from server\n";
+  auto connectStart = Clock::now();
+  auto configuration = getClientConfiguration(options, uri, seed);
+  auto connectDuration = Clock::since(connectStart);
+  auto result = options.rate > 0
+      ? runOpenLoop(options, parameterHandler, configuration.get())
+      : runClosedLoop(options, parameterHandler, configuration.get());
+  result.connectLatency.record(connectDuration);
+  if (auto replicated = dynamic_cast<ReplicatedConfiguration*>(configuration.get())) {
+    auto statistics = replicated->statistics();
+    result.policyGets = statistics.requests;
+    result.policySent = statistics.sent;
+    result.primaryLatency = statistics.primaryLatency;
+  }
+  result.requestLatency = parameterHandler.requestLatency.histogram;
+  result.lastStartWallTime = result.startWallTime;
+  result.startLateness.record(lateness);
+
+  printResult(result);
+  log() << "Slowest key: " << parameterHandler.requestLatency.slowestKey
+      << " (" << parameterHandler.requestLatency.slowestNanoseconds << " ns)\n";
+
+  if (!options.skipCheckValues) {
+    // Verify returned values. Open-loop requests are checked as they come in.
+    log() << "Checking parameters\n";
+    if (options.rate <= 0) {
+      result.mismatches = parameterHandler.check();
+    }
+
+    // Which directories differ tells which replica diverged, and where
+    if (!parameterHandler.divergedSubtrees.empty()) {
+      const auto& diverged = parameterHandler.divergedSubtrees;
+      auto servers = options.sharded || options.serverPolicy != SERVER_POLICY_PID
+          ? boost::algorithm::join(options.serverUris, ",") : uri;
+      std::cout << "Server '" << servers << "' diverged in " << diverged.size() << " directories:";
+      for (size_t i = 0; i < std::min(diverged.size(), size_t(5)); ++i) {
+        std::cout << ' ' << diverged[i];
+      }
+      std::cout << (diverged.size() > 5 ? " ...\n" : "\n");
+    }
+
+    if (sVerbose && !parameterHandler.streamCheck) {
+      log() << "# Generated\n";
+      printMapCsv(*parameterHandler.parameters);
+      log() << "# Returned\n";
+      printMapCsv(parameterHandler.returnedMap);
+    }
   }
+  return result;
+}
+
+/// Pins the calling thread to the n-th core it is allowed to run on, wrapping around
+void pinToCore(int n)
+{
+  cpu_set_t allowed;
+  CPU_ZERO(&allowed);
+  if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0 || CPU_COUNT(&allowed) == 0) {
+    log() << "Failed to get CPU affinity, not pinning thread\n";
+    return;
+  }
+
+  int target = n % CPU_COUNT(&allowed);
+  for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+    if (CPU_ISSET(cpu, &allowed) && target-- == 0) {
+      cpu_set_t pinned;
+      CPU_ZERO(&pinned);
+      CPU_SET(cpu, &pinned);
+      if (pthread_setaffinity_np(pthread_self(), sizeof(pinned), &pinned) != 0) {
+        log() << "Failed to pin thread to CPU " << cpu << '\n';
+      }
+      return;
+    }
+  }
+}
+
+/// Runs the workers as threads of this process, each with their own ParameterHandler and configuration
+GetResult runThreads(const Options& options, ParameterHandler& parameterHandler, StartBarrier& startBarrier)
+{
+  std::mutex mutex;
+  GetResult merged;
+  std::exception_ptr error;
+  bool verbose = sVerbose;
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < options.processNumber; ++i) {
+    threads.emplace_back([&, i]{
+      sVerbose = verbose && (i == 0); // Only the first thread talks
+      pinToCore(i);
+      try {
+        auto ownHandler = i == 0 ? nullptr : getParameterHandler(options);
+        if (ownHandler) {
+          prepareParameters(options, *ownHandler, &parameterHandler);
+        }
+        auto result = runWorker(options, ownHandler ? *ownHandler : parameterHandler, ::getpid() + i, startBarrier);
+        std::lock_guard<std::mutex> lock(mutex);
+        merged.merge(result);
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(mutex);
+        error = std::current_exception();
+      }
+    });
+  }
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  if (error) {
+    std::rethrow_exception(error);
+  }
+  return merged;
+}
+
+/// Merges and reports the results of all processes, including the spread of their start times
+void aggregateResults(const Options& options, const SharedResults& sharedResults)
+{
+  GetResult aggregate;
+  int failed = 0;
+  for (int i = 0; i < sharedResults.size(); ++i) {
+    if (auto result = sharedResults.get(i)) {
+      aggregate.merge(*result);
+    } else {
+      failed++;
+    }
+  }
+
+  Histogram startOffsets;
+  for (int i = 0; i < sharedResults.size(); ++i) {
+    if (auto result = sharedResults.get(i)) {
+      startOffsets.record(result->startWallTime - aggregate.startWallTime);
+    }
+  }
+
+  log() << "# Aggregated results of " << (sharedResults.size() - failed) << " processes\n";
+  if (failed > 0) {
+    std::cout << "Processes without results: " << failed << '\n';
+  }
+  printResult(aggregate);
+  printHistogram(startOffsets, "Start offset");
+
+  sendResult(options, aggregate, "aggregate.");
+  sendHistogram(startOffsets, "aggregate.start.offset", getTags(options));
+  Monitoring::MonitoringFactory::Get().sendTagged(failed, "aggregate.failed", getTags(options));
+}
+
+/// Wall-clock time in nanoseconds at which the clients should start, or 0 to start as soon as possible
+uint64_t getStartTime(const Options& options)
+{
+  if (options.skipWait) {
+    return 0;
+  }
+
+  auto startTime = options.startTime > 0 ? uint64_t(options.startTime * 1e9) : StartBarrier::nextInterval();
+  auto time = std::time_t(startTime / 1000000000);
+  log() << "Sleeping until " << std::put_time(std::localtime(&time), "%T") << '\n';
+  return startTime;
+}
+
+void doGet(const Options& options, ParameterHandler& parameterHandler) {
   if (options.monitoringConfigUri.empty()) {
     throw std::runtime_error("Monitoring URI required");
   }
 
+  // Generated once, before forking or starting threads, so all clients share the same arena
+  prepareParameters(options, parameterHandler);
+  if (parameterHandler.generated) {
+    log() << "Generated " << parameterHandler.generated->size() << " parameters, "
+        << parameterHandler.generated->memoryUsage() << " bytes\n";
+  } else {
+    log() << "Generating " << parameterHandler.parameters->size() << " parameters on demand\n";
+  }
+  fillMockStores(options, *parameterHandler.parameters);
+
+  if (options.watch) {
+    // The writer only writes to the first server, separate mock stores would never see the updates
+    auto store = MockConfiguration::isMockUri(options.serverUris.at(0))
+        ? MockConfiguration::getStore(options.serverUris.at(0)) : nullptr;
+    for (const auto& uri : options.serverUris) {
+      if (MockConfiguration::isMockUri(uri) != bool(store)
+          || (store && MockConfiguration::getStore(uri) != store)) {
+        throw std::runtime_error("Watching multiple servers requires them to be replicas, the mock URIs must all "
+            "name the same store");
+      }
+    }
+  }
+
+  bool watchWriter = options.watch && options.watchWrites > 0;
+  if (watchWriter) {
+    initializeWatchKeys(options);
+  }
+  if (options.watch && options.concurrencyModel == CONCURRENCY_PROCESSES && options.processNumber > 1) {
+    for (const auto& uri : options.serverUris) {
+      if (MockConfiguration::isMockUri(uri)) {
+        throw std::runtime_error("Watching the mock backend requires '--concurrency-model=" CONCURRENCY_THREADS "', "
+            "forked processes do not share its store");
+      }
+    }
+  }
+
+  // Determined once, before starting the clients, so they all agree on it
+  auto startTime = getStartTime(options);
+
+  if (options.concurrencyModel == CONCURRENCY_THREADS) {
+    log() << "Starting " << options.processNumber << " threads\n";
+    configureMonitoring(options);
+    StartBarrier startBarrier(options.processNumber + (watchWriter ? 1 : 0), startTime);
+    std::thread writer;
+    std::exception_ptr writerError;
+    if (watchWriter) {
+      writer = startWatchWriter(options, startBarrier, writerError);
+    }
+    auto merged = runThreads(options, parameterHandler, startBarrier);
+    if (writer.joinable()) {
+      writer.join();
+    }
+    if (writerError) {
+      std::rethrow_exception(writerError);
+    }
+    log() << "# Merged results of all threads\n";
+    printResult(merged);
+    sendResult(options, merged);
+    return;
+  }
+
+  if (options.processNumber > 1) {
+    log() << "Forking to get " << options.processNumber << " processes\n";
+  }
+
+  SharedResults sharedResults(options.processNumber);
+  SharedMemory startBarrierMemory(sizeof(StartBarrier));
+  auto startBarrier = new (startBarrierMemory.get()) StartBarrier(options.processNumber + (watchWriter ? 1 : 0),
+      startTime);
+  std::vector<pid_t> children;
+  int slot = 0;
+
   for (int i = 1; i < options.processNumber; ++i) {
     pid_t pid = fork();
     if (pid < 0) {
       throw std::runtime_error("Fork error");
     } else if (pid == 0) {
       sVerbose = false; // Children should be silent
+      slot = i;
       break; // Children exit loop
     }
     // Parent continues
+    children.push_back(pid);
   }
 
-  configureMonitoring(options);
-
-  // Wait for next minute if required
-  if (!options.skipWait) {
-    log() << "Waiting until next interval\n";
-    waitUntilNextInterval();
+  // The parent writes the watch updates, started after forking so the children do not inherit the thread
+  std::thread writer;
+  std::exception_ptr writerError;
+  if (watchWriter && slot == 0) {
+    writer = startWatchWriter(options, *startBarrier, writerError);
   }
 
-  // Get parameters from server
-  log() << "Getting from server\n";
-  std::string uri = selectUri(options);
-  auto configuration = Configuration::ConfigurationFactory::getConfiguration(uri);
-  auto startTime = std::chrono::system_clock::now();
-  parameterHandler.get(configuration.get(), options.parameterNumber);
-  auto endTime = std::chrono::system_clock::now();
-
-  try {
-    auto start = toMillis(startTime.time_since_epoch());
-    auto end = toMillis(endTime.time_since_epoch());
-
-    const std::vector<Monitoring::Tag> tags {
-      {"process.number", std::to_string(options.processNumber)},
-      {"param.number", std::to_string(options.parameterNumber)},
-      {"param.structure", options.parameterStructure},
-    };
-
-    auto& monitoring = Monitoring::MonitoringFactory::Get();
-    monitoring.sendTagged<uint64_t>(start, "time", std::vector<Monitoring::Tag>(tags));
-    monitoring.sendTagged<uint64_t>(end, "time", std::vector<Monitoring::Tag>(tags));
+  configureMonitoring(options);
+  auto result = runWorker(options, parameterHandler, ::getpid(), *startBarrier);
+  if (writer.joinable()) {
+    writer.join();
   }
-  catch (const std::exception& e) {
-    throw std::runtime_error(std::string("Failed to send monitoring data - ") + e.what());
+  if (writerError) {
+    std::rethrow_exception(writerError);
   }
+  if (!options.aggregateOnly || options.processNumber == 1) {
+    sendResult(options, result);
+  }
+  sharedResults.publish(slot, result);
 
-  if (!options.skipCheckValues) {
-    // Verify returned values
-    log() << "Checking parameters\n";
-    int mismatches = parameterHandler.check();
-    if (mismatches > 0) {
-      std::cout << "Mismatches found: " << mismatches << '\n';
-      Monitoring::MonitoringFactory::Get().sendTagged(mismatches, "mismatches", {});
-    }
+  if (slot != 0 || options.processNumber == 1) {
+    return;
+  }
 
-    if (sVerbose) {
-      log() << "# Generated\n";
-      printMapCsv(parameterHandler.generatedMap);
-      log() << "# Returned\n";
-      printMapCsv(parameterHandler.returnedMap);
-    }
+  // The parent waits for its children, and reports the aggregate results
+  for (auto pid : children) {
+    int status = 0;
+    waitpid(pid, &status, 0);
   }
+  aggregateResults(options, sharedResults);
 }
 } // Anonymous namespace
 
@@ -607,11 +2471,17 @@ int main(int argc, char** argv)
       return 0;
     }
 
+    sValueGenerator = ValueGenerator(options.valueSize, options.valueContent);
+
+    // Calibrate before any forking, so all processes share the same correction
+    log() << "Clock overhead: " << Clock::calibrate() << " ns\n";
+
     auto parameterHandler = getParameterHandler(options);
 
     if (options.printParams) {
       log() << "Printing parameters\n";
-      printMapCsv(parameterHandler->createParameterMap(options.parameterNumber));
+      parameterHandler->prepare(options.parameterNumber);
+      printMapCsv(*parameterHandler->parameters);
     }
     else if (options.put) {
       doPut(options, *parameterHandler.get());
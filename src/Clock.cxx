@@ -0,0 +1,73 @@
+/// \file Clock.cxx
+/// \brief Implementation of the Clock class.
+
+#include "Clock.h"
+#include <time.h>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+namespace AliceO2
+{
+namespace ConfigurationBenchmark
+{
+
+uint64_t Clock::sOverhead = 0;
+
+uint64_t Clock::now()
+{
+#ifdef CLOCK_MONOTONIC_RAW
+  timespec time;
+  clock_gettime(CLOCK_MONOTONIC_RAW, &time);
+  return uint64_t(time.tv_sec) * 1000000000 + uint64_t(time.tv_nsec);
+#else
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+uint64_t Clock::wallNow()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+void Clock::sleepUntil(uint64_t deadline)
+{
+  // Sleeps tend to overshoot by tens of microseconds, so we stop sleeping a bit early and spin the rest of the way
+  constexpr uint64_t spinNanoseconds = 50000;
+
+  auto current = now();
+  if (deadline > current + spinNanoseconds) {
+    std::this_thread::sleep_for(std::chrono::nanoseconds(deadline - current - spinNanoseconds));
+  }
+
+  while (now() < deadline) {
+  }
+}
+
+uint64_t Clock::calibrate()
+{
+  constexpr int samples = 10000;
+
+  // Warm up, so the first readings don't pay for page faults and cold caches
+  for (int i = 0; i < 1000; ++i) {
+    now();
+  }
+
+  std::vector<uint64_t> deltas(samples);
+  for (auto& delta : deltas) {
+    uint64_t start = now();
+    uint64_t end = now();
+    delta = end - start;
+  }
+
+  // The median is robust against the occasional interrupt or context switch
+  std::nth_element(deltas.begin(), deltas.begin() + samples / 2, deltas.end());
+  sOverhead = deltas[samples / 2];
+  return sOverhead;
+}
+
+} // namespace ConfigurationBenchmark
+} // namespace AliceO2
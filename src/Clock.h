@@ -0,0 +1,85 @@
+/// \file Clock.h
+/// \brief Definition of the Clock class, the timing source for all benchmark measurements, and the ScopedTimer class.
+
+#ifndef ALICEO2_CONFIGURATIONBENCHMARK_CLOCK_H
+#define ALICEO2_CONFIGURATIONBENCHMARK_CLOCK_H
+
+#include <cstdint>
+
+namespace AliceO2
+{
+namespace ConfigurationBenchmark
+{
+
+/// Nanosecond timing source for measurements.
+///
+/// Durations are measured with a monotonic clock that is not affected by NTP adjustments (CLOCK_MONOTONIC_RAW where
+/// available). The cost of reading the clock is measured once by calibrate() and subtracted from every duration.
+/// Wall-clock time is only meant for timestamps that need to be correlated across nodes, never for durations.
+class Clock
+{
+  public:
+    /// Monotonic time in nanoseconds, with an arbitrary epoch
+    static uint64_t now();
+
+    /// Wall-clock time in nanoseconds since the Unix epoch
+    static uint64_t wallNow();
+
+    /// Nanoseconds between two now() readings, corrected for the overhead of reading the clock
+    static uint64_t elapsed(uint64_t start, uint64_t end)
+    {
+      uint64_t raw = end > start ? end - start : 0;
+      return raw > sOverhead ? raw - sOverhead : 0;
+    }
+
+    /// Nanoseconds since the given now() reading, corrected for the overhead of reading the clock
+    static uint64_t since(uint64_t start)
+    {
+      return elapsed(start, now());
+    }
+
+    /// Waits until the given now() reading. Sleeps for most of the time and spins for the last stretch, which is much
+    /// more precise than only sleeping.
+    static void sleepUntil(uint64_t deadline);
+
+    /// Measures the overhead of an empty timed section. Should be called once at startup, before forking.
+    /// \return The overhead in nanoseconds
+    static uint64_t calibrate();
+
+    /// The overhead determined by calibrate()
+    static uint64_t overhead()
+    {
+      return sOverhead;
+    }
+
+  private:
+    static uint64_t sOverhead;
+};
+
+/// Adds the time from its construction to its destruction to a total in nanoseconds. For phases that are split over
+/// several sections, so the total of a phase can be recorded once it is complete.
+class ScopedTimer
+{
+  public:
+    explicit ScopedTimer(uint64_t& total)
+        : mTotal(total), mStart(Clock::now())
+    {
+    }
+
+    ~ScopedTimer()
+    {
+      mTotal += Clock::since(mStart);
+    }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+  private:
+    uint64_t& mTotal;
+    uint64_t mStart;
+};
+
+} // namespace ConfigurationBenchmark
+} // namespace AliceO2
+
+#endif // ALICEO2_CONFIGURATIONBENCHMARK_CLOCK_H
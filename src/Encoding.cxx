@@ -0,0 +1,156 @@
+/// \file Encoding.cxx
+/// \brief Implementation of the encoding helpers.
+
+#include "Encoding.h"
+#include <cctype>
+#include <cstdint>
+#include <cstdio>
+
+namespace AliceO2
+{
+namespace ConfigurationBenchmark
+{
+namespace
+{
+const std::string BASE64_CHARACTERS = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+} // Anonymous namespace
+
+std::string base64Encode(boost::string_ref input)
+{
+  std::string output;
+  output.reserve((input.size() + 2) / 3 * 4);
+  size_t i = 0;
+  for (; i + 2 < input.size(); i += 3) {
+    uint32_t triple = (uint8_t(input[i]) << 16) | (uint8_t(input[i + 1]) << 8) | uint8_t(input[i + 2]);
+    output += BASE64_CHARACTERS[(triple >> 18) & 0x3f];
+    output += BASE64_CHARACTERS[(triple >> 12) & 0x3f];
+    output += BASE64_CHARACTERS[(triple >> 6) & 0x3f];
+    output += BASE64_CHARACTERS[triple & 0x3f];
+  }
+  if (i < input.size()) {
+    uint32_t triple = uint8_t(input[i]) << 16;
+    if (i + 1 < input.size()) {
+      triple |= uint8_t(input[i + 1]) << 8;
+    }
+    output += BASE64_CHARACTERS[(triple >> 18) & 0x3f];
+    output += BASE64_CHARACTERS[(triple >> 12) & 0x3f];
+    output += (i + 1 < input.size()) ? BASE64_CHARACTERS[(triple >> 6) & 0x3f] : '=';
+    output += '=';
+  }
+  return output;
+}
+
+std::string base64Decode(const std::string& input)
+{
+  std::string output;
+  uint32_t buffer = 0;
+  int bits = 0;
+  for (char c : input) {
+    auto position = BASE64_CHARACTERS.find(c);
+    if (position == std::string::npos) {
+      continue; // Padding and whitespace
+    }
+    buffer = (buffer << 6) | uint32_t(position);
+    bits += 6;
+    if (bits >= 8) {
+      bits -= 8;
+      output += char((buffer >> bits) & 0xff);
+    }
+  }
+  return output;
+}
+
+std::string urlEncode(boost::string_ref input, bool keepSlashes)
+{
+  static const char* hex = "0123456789ABCDEF";
+  std::string output;
+  output.reserve(input.size());
+  for (char c : input) {
+    if (std::isalnum(uint8_t(c)) || c == '-' || c == '.' || c == '_' || c == '~' || (c == '/' && keepSlashes)) {
+      output += c;
+    } else {
+      output += '%';
+      output += hex[uint8_t(c) >> 4];
+      output += hex[uint8_t(c) & 0xf];
+    }
+  }
+  return output;
+}
+
+std::string jsonString(const std::string& input)
+{
+  std::string output = "\"";
+  for (char c : input) {
+    switch (c) {
+      case '"': output += "\\\""; break;
+      case '\\': output += "\\\\"; break;
+      case '\n': output += "\\n"; break;
+      case '\r': output += "\\r"; break;
+      case '\t': output += "\\t"; break;
+      default:
+        if (uint8_t(c) < 0x20) {
+          char escaped[8];
+          snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+          output += escaped;
+        } else {
+          output += c;
+        }
+    }
+  }
+  return output + "\"";
+}
+
+std::string jsonStringField(const std::string& json, const std::string& name, size_t* position)
+{
+  auto fail = [&] {
+    if (position) {
+      *position = std::string::npos;
+    }
+    return std::string();
+  };
+
+  auto field = json.find('"' + name + '"', position ? *position : 0);
+  if (field == std::string::npos) {
+    return fail();
+  }
+  auto colon = json.find(':', field + name.size() + 2);
+  auto start = colon == std::string::npos ? colon : json.find_first_not_of(" \t\r\n", colon + 1);
+  if (start == std::string::npos) {
+    return fail();
+  }
+  if (json.compare(start, 4, "null") == 0) {
+    if (position) {
+      *position = start + 4;
+    }
+    return std::string();
+  }
+  if (json[start] != '"') {
+    return fail();
+  }
+  auto end = json.find('"', start + 1);
+  if (end == std::string::npos) {
+    return fail();
+  }
+  if (position) {
+    *position = end + 1;
+  }
+  return json.substr(start + 1, end - start - 1);
+}
+
+void appendDecimal(uint64_t number, size_t width, std::string& buffer)
+{
+  char digits[20];
+  size_t count = 0;
+  do {
+    digits[count++] = char('0' + number % 10);
+    number /= 10;
+  } while (number > 0);
+
+  buffer.append(width > count ? width - count : 0, '0');
+  while (count > 0) {
+    buffer += digits[--count];
+  }
+}
+
+} // namespace ConfigurationBenchmark
+} // namespace AliceO2
@@ -0,0 +1,40 @@
+/// \file Encoding.h
+/// \brief Encoding helpers shared by the stand-in server, the HTTP batch writers and the parameter generation.
+
+#ifndef ALICEO2_CONFIGURATIONBENCHMARK_ENCODING_H
+#define ALICEO2_CONFIGURATIONBENCHMARK_ENCODING_H
+
+#include <cstdint>
+#include <string>
+#include <boost/utility/string_ref.hpp>
+
+namespace AliceO2
+{
+namespace ConfigurationBenchmark
+{
+
+std::string base64Encode(boost::string_ref input);
+
+/// Skips padding and characters outside of the base64 alphabet
+std::string base64Decode(const std::string& input);
+
+/// Percent-encodes all but the unreserved characters of RFC 3986
+/// \param keepSlashes Whether to keep slashes, for encoding a path instead of a form or query value
+std::string urlEncode(boost::string_ref input, bool keepSlashes);
+
+/// Quotes and escapes a string for use in JSON
+std::string jsonString(const std::string& input);
+
+/// Finds a string field in JSON. Good enough for the requests of the Consul and etcd APIs as sent by clients, which
+/// only have unescaped or base64 encoded strings. A null field gives an empty string, other values are not found.
+/// \param position If given, where to start searching. Set to the end of the field, or npos if it was not found,
+///   so repeated calls iterate over the fields of an array of objects.
+std::string jsonStringField(const std::string& json, const std::string& name, size_t* position = nullptr);
+
+/// Appends the decimal digits of the number, zero-padded to the width, without allocating beyond the buffer growth
+void appendDecimal(uint64_t number, size_t width, std::string& buffer);
+
+} // namespace ConfigurationBenchmark
+} // namespace AliceO2
+
+#endif // ALICEO2_CONFIGURATIONBENCHMARK_ENCODING_H
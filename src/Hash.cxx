@@ -0,0 +1,101 @@
+/// \file Hash.cxx
+/// \brief Implementation of the hashing functions.
+
+#include "Hash.h"
+#include <cstring>
+
+namespace AliceO2
+{
+namespace ConfigurationBenchmark
+{
+namespace
+{
+constexpr uint64_t PRIME1 = 11400714785074694791ull;
+constexpr uint64_t PRIME2 = 14029467366897019727ull;
+constexpr uint64_t PRIME3 = 1609587929392839161ull;
+constexpr uint64_t PRIME4 = 9650029242287828579ull;
+constexpr uint64_t PRIME5 = 2870177450012600261ull;
+
+uint64_t rotateLeft(uint64_t value, int bits)
+{
+  return (value << bits) | (value >> (64 - bits));
+}
+
+uint64_t read64(const char* data)
+{
+  uint64_t value;
+  std::memcpy(&value, data, sizeof(value));
+  return value;
+}
+
+uint32_t read32(const char* data)
+{
+  uint32_t value;
+  std::memcpy(&value, data, sizeof(value));
+  return value;
+}
+
+uint64_t round(uint64_t accumulator, uint64_t input)
+{
+  accumulator += input * PRIME2;
+  return rotateLeft(accumulator, 31) * PRIME1;
+}
+
+uint64_t mergeRound(uint64_t accumulator, uint64_t value)
+{
+  accumulator ^= round(0, value);
+  return accumulator * PRIME1 + PRIME4;
+}
+} // Anonymous namespace
+
+uint64_t hash64(boost::string_ref data, uint64_t seed)
+{
+  auto position = data.data();
+  auto end = position + data.size();
+  uint64_t hash;
+
+  if (data.size() >= 32) {
+    uint64_t v1 = seed + PRIME1 + PRIME2;
+    uint64_t v2 = seed + PRIME2;
+    uint64_t v3 = seed;
+    uint64_t v4 = seed - PRIME1;
+    for (; position + 32 <= end; position += 32) {
+      v1 = round(v1, read64(position));
+      v2 = round(v2, read64(position + 8));
+      v3 = round(v3, read64(position + 16));
+      v4 = round(v4, read64(position + 24));
+    }
+    hash = rotateLeft(v1, 1) + rotateLeft(v2, 7) + rotateLeft(v3, 12) + rotateLeft(v4, 18);
+    hash = mergeRound(hash, v1);
+    hash = mergeRound(hash, v2);
+    hash = mergeRound(hash, v3);
+    hash = mergeRound(hash, v4);
+  } else {
+    hash = seed + PRIME5;
+  }
+
+  hash += data.size();
+  for (; position + 8 <= end; position += 8) {
+    hash ^= round(0, read64(position));
+    hash = rotateLeft(hash, 27) * PRIME1 + PRIME4;
+  }
+  if (position + 4 <= end) {
+    hash ^= uint64_t(read32(position)) * PRIME1;
+    hash = rotateLeft(hash, 23) * PRIME2 + PRIME3;
+    position += 4;
+  }
+  for (; position < end; ++position) {
+    hash ^= uint64_t(uint8_t(*position)) * PRIME5;
+    hash = rotateLeft(hash, 11) * PRIME1;
+  }
+
+  hash ^= hash >> 33;
+  hash *= PRIME2;
+  hash ^= hash >> 29;
+  hash *= PRIME3;
+  hash ^= hash >> 32;
+  return hash;
+}
+
+} // namespace ConfigurationBenchmark
+} // namespace AliceO2
@@ -0,0 +1,22 @@
+/// \file Hash.h
+/// \brief Fast non-cryptographic hashing of keys and values.
+
+#ifndef ALICEO2_CONFIGURATIONBENCHMARK_HASH_H
+#define ALICEO2_CONFIGURATIONBENCHMARK_HASH_H
+
+#include <cstdint>
+#include <boost/utility/string_ref.hpp>
+
+namespace AliceO2
+{
+namespace ConfigurationBenchmark
+{
+
+/// XXH64 of the data, which hashes several gigabytes per second. Reads the input as little-endian, so the hashes
+/// of other architectures differ from the reference implementation.
+uint64_t hash64(boost::string_ref data, uint64_t seed = 0);
+
+} // namespace ConfigurationBenchmark
+} // namespace AliceO2
+
+#endif // ALICEO2_CONFIGURATIONBENCHMARK_HASH_H
@@ -0,0 +1,101 @@
+/// \file Histogram.cxx
+/// \brief Implementation of the Histogram class.
+
+#include "Histogram.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace AliceO2
+{
+namespace ConfigurationBenchmark
+{
+
+constexpr int Histogram::SUB_BUCKET_BITS;
+constexpr int Histogram::SUB_BUCKET_COUNT;
+constexpr int Histogram::SUB_BUCKET_HALF_COUNT;
+constexpr int Histogram::MAX_VALUE_BITS;
+constexpr uint64_t Histogram::MAX_VALUE;
+constexpr int Histogram::BUCKET_COUNT;
+
+Histogram::Histogram()
+{
+  reset();
+}
+
+void Histogram::reset()
+{
+  mCounts.fill(0);
+  mCount = 0;
+  mSum = 0;
+  mMin = std::numeric_limits<uint64_t>::max();
+  mMax = 0;
+}
+
+int Histogram::bucketIndex(uint64_t value)
+{
+  if (value < SUB_BUCKET_COUNT) {
+    return int(value);
+  }
+
+  // Shift the value so it lands in the upper half of the sub-buckets: [64, 127]
+  int mostSignificantBit = 63 - __builtin_clzll(value);
+  int shift = mostSignificantBit - (SUB_BUCKET_BITS - 1);
+  int subBucket = int(value >> shift) - SUB_BUCKET_HALF_COUNT;
+  return SUB_BUCKET_COUNT + (shift - 1) * SUB_BUCKET_HALF_COUNT + subBucket;
+}
+
+uint64_t Histogram::bucketHighestValue(int index)
+{
+  if (index < SUB_BUCKET_COUNT) {
+    return uint64_t(index);
+  }
+
+  int shift = (index - SUB_BUCKET_COUNT) / SUB_BUCKET_HALF_COUNT + 1;
+  uint64_t subBucket = (index - SUB_BUCKET_COUNT) % SUB_BUCKET_HALF_COUNT + SUB_BUCKET_HALF_COUNT;
+  return ((subBucket + 1) << shift) - 1;
+}
+
+void Histogram::record(uint64_t value)
+{
+  value = std::min(value, MAX_VALUE);
+  mCounts[bucketIndex(value)]++;
+  mCount++;
+  mSum += value;
+  mMin = std::min(mMin, value);
+  mMax = std::max(mMax, value);
+}
+
+void Histogram::merge(const Histogram& other)
+{
+  for (int i = 0; i < BUCKET_COUNT; ++i) {
+    mCounts[i] += other.mCounts[i];
+  }
+  mCount += other.mCount;
+  mSum += other.mSum;
+  mMin = std::min(mMin, other.mMin);
+  mMax = std::max(mMax, other.mMax);
+}
+
+uint64_t Histogram::percentile(double percentile) const
+{
+  if (mCount == 0) {
+    return 0;
+  }
+
+  percentile = std::max(0.0, std::min(percentile, 100.0));
+  auto wanted = std::max(uint64_t(1), uint64_t(std::ceil((percentile / 100.0) * double(mCount))));
+
+  uint64_t seen = 0;
+  for (int i = 0; i < BUCKET_COUNT; ++i) {
+    seen += mCounts[i];
+    if (seen >= wanted) {
+      // Report the highest value equivalent to the bucket, but never more than what was actually recorded
+      return std::max(mMin, std::min(bucketHighestValue(i), mMax));
+    }
+  }
+  return mMax;
+}
+
+} // namespace ConfigurationBenchmark
+} // namespace AliceO2
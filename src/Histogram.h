@@ -0,0 +1,84 @@
+/// \file Histogram.h
+/// \brief Definition of the Histogram class, a log-bucketed latency histogram.
+
+#ifndef ALICEO2_CONFIGURATIONBENCHMARK_HISTOGRAM_H
+#define ALICEO2_CONFIGURATIONBENCHMARK_HISTOGRAM_H
+
+#include <array>
+#include <cstdint>
+
+namespace AliceO2
+{
+namespace ConfigurationBenchmark
+{
+
+/// HDR-style histogram for latencies in nanoseconds.
+///
+/// Values below 128 are counted exactly. Above that, every power-of-two range is split into 64 linear sub-buckets,
+/// which keeps the relative error of a recorded value at most 1/64, under 2%. Values above 2^40 ns (~18 minutes) are
+/// clamped.
+/// The storage is a fixed-size array so histograms can be copied around and merged cheaply.
+class Histogram
+{
+  public:
+    static constexpr int SUB_BUCKET_BITS = 7;
+    static constexpr int SUB_BUCKET_COUNT = 1 << SUB_BUCKET_BITS;
+    static constexpr int SUB_BUCKET_HALF_COUNT = SUB_BUCKET_COUNT / 2;
+    static constexpr int MAX_VALUE_BITS = 40;
+    static constexpr uint64_t MAX_VALUE = (uint64_t(1) << MAX_VALUE_BITS) - 1;
+    static constexpr int BUCKET_COUNT = SUB_BUCKET_COUNT + (MAX_VALUE_BITS - SUB_BUCKET_BITS) * SUB_BUCKET_HALF_COUNT;
+
+    Histogram();
+
+    /// Record a single value
+    void record(uint64_t value);
+
+    /// Add all values recorded in the other histogram to this one
+    void merge(const Histogram& other);
+
+    /// Clear all recorded values
+    void reset();
+
+    /// Value at the given percentile [0, 100]. Returns 0 if the histogram is empty.
+    uint64_t percentile(double percentile) const;
+
+    uint64_t count() const
+    {
+      return mCount;
+    }
+
+    uint64_t min() const
+    {
+      return mCount == 0 ? 0 : mMin;
+    }
+
+    uint64_t max() const
+    {
+      return mMax;
+    }
+
+    double mean() const
+    {
+      return mCount == 0 ? 0.0 : double(mSum) / double(mCount);
+    }
+
+    uint64_t sum() const
+    {
+      return mSum;
+    }
+
+  private:
+    static int bucketIndex(uint64_t value);
+    static uint64_t bucketHighestValue(int index);
+
+    std::array<uint64_t, BUCKET_COUNT> mCounts;
+    uint64_t mCount;
+    uint64_t mSum;
+    uint64_t mMin;
+    uint64_t mMax;
+};
+
+} // namespace ConfigurationBenchmark
+} // namespace AliceO2
+
+#endif // ALICEO2_CONFIGURATIONBENCHMARK_HISTOGRAM_H
@@ -0,0 +1,292 @@
+/// \file HttpClient.cxx
+/// \brief Implementation of the HttpClient class.
+
+#include "HttpClient.h"
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+#include <boost/algorithm/string.hpp>
+
+namespace AliceO2
+{
+namespace ConfigurationBenchmark
+{
+
+HttpUri parseHttpUri(const std::string& uri, const std::string& scheme, int defaultPort)
+{
+  HttpUri parsed;
+  auto rest = uri.substr(scheme.size());
+  auto slash = rest.find('/');
+  auto authority = rest.substr(0, slash);
+  parsed.prefix = slash == std::string::npos ? "" : rest.substr(slash);
+
+  auto colon = authority.rfind(':');
+  parsed.host = authority.substr(0, colon);
+  parsed.port = colon == std::string::npos ? defaultPort : std::stoi(authority.substr(colon + 1));
+  if (parsed.host.empty()) {
+    throw std::runtime_error("No host in URI '" + uri + "'");
+  }
+  return parsed;
+}
+
+std::string joinKey(const std::string& prefix, const std::string& key)
+{
+  if (!prefix.empty() && prefix.back() == '/' && !key.empty() && key.front() == '/') {
+    return prefix + key.substr(1);
+  }
+  return prefix + key;
+}
+
+HttpClient::HttpClient(const std::string& host, int port)
+    : mHost(host), mPort(port), mSocket(-1), mReceived(0)
+{
+}
+
+HttpClient::~HttpClient()
+{
+  disconnect();
+}
+
+void HttpClient::connect()
+{
+  addrinfo hints;
+  std::memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+
+  addrinfo* addresses = nullptr;
+  auto error = ::getaddrinfo(mHost.c_str(), std::to_string(mPort).c_str(), &hints, &addresses);
+  if (error != 0) {
+    throw std::runtime_error("Failed to resolve '" + mHost + "': " + ::gai_strerror(error));
+  }
+
+  for (auto address = addresses; address != nullptr; address = address->ai_next) {
+    mSocket = ::socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+    if (mSocket < 0) {
+      continue;
+    }
+    if (::connect(mSocket, address->ai_addr, address->ai_addrlen) == 0) {
+      break;
+    }
+    ::close(mSocket);
+    mSocket = -1;
+  }
+  ::freeaddrinfo(addresses);
+
+  if (mSocket < 0) {
+    throw std::runtime_error("Failed to connect to '" + mHost + ":" + std::to_string(mPort) + "': "
+        + std::strerror(errno));
+  }
+  int one = 1;
+  ::setsockopt(mSocket, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+  mBuffer.clear();
+}
+
+void HttpClient::disconnect()
+{
+  if (mSocket >= 0) {
+    ::close(mSocket);
+    mSocket = -1;
+  }
+}
+
+void HttpClient::send(const std::string& data)
+{
+  size_t sent = 0;
+  while (sent < data.size()) {
+    auto n = ::send(mSocket, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      throw std::runtime_error(std::string("Failed to send HTTP request: ") + std::strerror(errno));
+    }
+    sent += size_t(n);
+  }
+}
+
+bool HttpClient::fill()
+{
+  char buffer[64 * 1024];
+  while (true) {
+    auto n = ::recv(mSocket, buffer, sizeof(buffer), 0);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n < 0) {
+      throw std::runtime_error(std::string("Failed to receive HTTP response: ") + std::strerror(errno));
+    }
+    mBuffer.append(buffer, size_t(n));
+    mReceived += uint64_t(n);
+    return n > 0;
+  }
+}
+
+auto HttpClient::receive() -> Response
+{
+  size_t headerEnd;
+  while ((headerEnd = mBuffer.find("\r\n\r\n")) == std::string::npos) {
+    if (!fill()) {
+      throw std::runtime_error("Connection closed before the HTTP response headers were received");
+    }
+  }
+
+  std::vector<std::string> lines;
+  boost::split(lines, mBuffer.substr(0, headerEnd), boost::is_any_of("\n"));
+  mBuffer.erase(0, headerEnd + 4);
+
+  Response response;
+  auto statusStart = lines.at(0).find(' ');
+  if (statusStart == std::string::npos) {
+    throw std::runtime_error("Invalid HTTP status line '" + lines.at(0) + "'");
+  }
+  response.status = std::atoi(lines.at(0).c_str() + statusStart + 1);
+
+  long contentLength = -1;
+  bool chunked = false;
+  bool close = false;
+  for (size_t i = 1; i < lines.size(); ++i) {
+    auto colon = lines[i].find(':');
+    if (colon == std::string::npos) {
+      continue;
+    }
+    auto name = boost::to_lower_copy(lines[i].substr(0, colon));
+    auto value = boost::trim_copy(lines[i].substr(colon + 1));
+    response.headers[name] = value;
+    if (name == "content-length") {
+      contentLength = std::stol(value);
+    } else if (name == "transfer-encoding") {
+      chunked = boost::icontains(value, "chunked");
+    } else if (name == "connection") {
+      close = boost::iequals(value, "close");
+    }
+  }
+
+  if (chunked) {
+    while (true) {
+      size_t lineEnd;
+      while ((lineEnd = mBuffer.find("\r\n")) == std::string::npos) {
+        if (!fill()) {
+          throw std::runtime_error("Connection closed in a chunked HTTP response");
+        }
+      }
+      auto size = std::stoul(mBuffer.substr(0, lineEnd), nullptr, 16);
+      while (mBuffer.size() < lineEnd + 2 + size + 2) {
+        if (!fill()) {
+          throw std::runtime_error("Connection closed in a chunked HTTP response");
+        }
+      }
+      response.body.append(mBuffer, lineEnd + 2, size);
+      mBuffer.erase(0, lineEnd + 2 + size + 2);
+      if (size == 0) {
+        break; // Trailers are not supported
+      }
+    }
+  } else if (contentLength >= 0) {
+    while (mBuffer.size() < size_t(contentLength)) {
+      if (!fill()) {
+        throw std::runtime_error("Connection closed in an HTTP response");
+      }
+    }
+    response.body = mBuffer.substr(0, contentLength);
+    mBuffer.erase(0, contentLength);
+  } else {
+    while (fill()) {
+    }
+    response.body.swap(mBuffer);
+    close = true;
+  }
+
+  if (close) {
+    disconnect();
+  }
+  return response;
+}
+
+std::string HttpClient::serialize(const Request& request) const
+{
+  return request.method + " " + request.path + " HTTP/1.1\r\nHost: " + mHost + ":" + std::to_string(mPort)
+      + "\r\nContent-Type: " + request.contentType + "\r\nContent-Length: " + std::to_string(request.body.size())
+      + "\r\n\r\n" + request.body;
+}
+
+auto HttpClient::request(const std::string& method, const std::string& path, const std::string& body,
+    const std::string& contentType) -> Response
+{
+  auto request = serialize(Request{method, path, body, contentType});
+
+  // A kept-alive connection may have been closed by the server in the meantime, then retry once on a new one. Only
+  // if nothing of a response arrived, otherwise the server got the request, and may have applied it.
+  bool reused = mSocket >= 0;
+  if (!reused) {
+    connect();
+  }
+  auto received = mReceived;
+  try {
+    send(request);
+    return receive();
+  } catch (const std::exception&) {
+    disconnect();
+    if (!reused || mReceived != received) {
+      throw;
+    }
+  }
+  try {
+    connect();
+    send(request);
+    return receive();
+  } catch (const std::exception&) {
+    disconnect();
+    throw;
+  }
+}
+
+auto HttpClient::pipeline(const std::vector<Request>& requests) -> std::vector<Response>
+{
+  std::string data;
+  for (const auto& request : requests) {
+    data += serialize(request);
+  }
+  auto exchange = [&] {
+    send(data);
+    std::vector<Response> responses;
+    while (responses.size() != requests.size()) {
+      if (mSocket < 0) {
+        throw std::runtime_error("Connection closed by the server in pipelined HTTP requests");
+      }
+      responses.push_back(receive());
+    }
+    return responses;
+  };
+
+  // Like request(), but all are sent again if no response arrived
+  bool reused = mSocket >= 0;
+  if (!reused) {
+    connect();
+  }
+  auto received = mReceived;
+  try {
+    return exchange();
+  } catch (const std::exception&) {
+    disconnect();
+    if (!reused || mReceived != received) {
+      throw;
+    }
+  }
+  try {
+    connect();
+    return exchange();
+  } catch (const std::exception&) {
+    disconnect();
+    throw;
+  }
+}
+
+} // namespace ConfigurationBenchmark
+} // namespace AliceO2
@@ -0,0 +1,86 @@
+/// \file HttpClient.h
+/// \brief Definition of the HttpClient class, a minimal blocking HTTP/1.1 client.
+
+#ifndef ALICEO2_CONFIGURATIONBENCHMARK_HTTPCLIENT_H
+#define ALICEO2_CONFIGURATIONBENCHMARK_HTTPCLIENT_H
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace AliceO2
+{
+namespace ConfigurationBenchmark
+{
+
+/// Parts of a backend URI of the form "SCHEME://HOST:PORT/PREFIX"
+struct HttpUri
+{
+    std::string host;
+    int port;
+    std::string prefix;
+};
+
+HttpUri parseHttpUri(const std::string& uri, const std::string& scheme, int defaultPort);
+
+/// Joins the prefix and the key with a single slash
+std::string joinKey(const std::string& prefix, const std::string& key);
+
+/// Blocking HTTP/1.1 client over a single keep-alive connection, for the backend APIs the Configuration library does
+/// not expose, such as transactions. Reconnects when the server closed the connection. Not thread-safe.
+class HttpClient
+{
+  public:
+    struct Response
+    {
+        int status = 0;
+        std::map<std::string, std::string> headers; ///< Header names are lowercase
+        std::string body;
+    };
+
+    HttpClient(const std::string& host, int port);
+    ~HttpClient();
+
+    HttpClient(const HttpClient&) = delete;
+    HttpClient& operator=(const HttpClient&) = delete;
+
+    struct Request
+    {
+        std::string method;
+        std::string path;
+        std::string body;
+        std::string contentType = "application/json";
+    };
+
+    Response request(const std::string& method, const std::string& path, const std::string& body,
+        const std::string& contentType = "application/json");
+
+    /// Sends the requests back to back before receiving any response (HTTP/1.1 pipelining), so they cost one round
+    /// trip instead of one each. Only for requests that are safe to send again, as they are all retried on a new
+    /// connection if the kept-alive one turns out to be closed.
+    /// \return The responses, in the order of the requests
+    std::vector<Response> pipeline(const std::vector<Request>& requests);
+
+  private:
+    void connect();
+    void disconnect();
+    void send(const std::string& data);
+    Response receive();
+    std::string serialize(const Request& request) const;
+
+    /// Reads more data into mBuffer
+    /// \return False if the connection was closed
+    bool fill();
+
+    std::string mHost;
+    int mPort;
+    int mSocket;
+    std::string mBuffer; ///< Received but not yet consumed data
+    uint64_t mReceived; ///< Bytes received so far, to tell whether a failed request got part of a response
+};
+
+} // namespace ConfigurationBenchmark
+} // namespace AliceO2
+
+#endif // ALICEO2_CONFIGURATIONBENCHMARK_HTTPCLIENT_H
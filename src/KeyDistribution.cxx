@@ -0,0 +1,132 @@
+/// \file KeyDistribution.cxx
+/// \brief Implementation of the KeyDistribution class.
+
+#include "KeyDistribution.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+#include <boost/algorithm/string.hpp>
+#include <boost/lexical_cast.hpp>
+
+namespace AliceO2
+{
+namespace ConfigurationBenchmark
+{
+namespace
+{
+constexpr uint64_t PERMUTATION_SEED = 0x5eed; ///< Fixed, so all processes agree on the hot keys
+} // Anonymous namespace
+
+KeyDistribution::KeyDistribution(const std::string& specification, size_t keys)
+    : mKeys(keys), mHotKeys(0), mHotProbability(0)
+{
+  std::vector<std::string> parts;
+  boost::split(parts, specification, boost::is_any_of(":"));
+  auto expectParameters = [&](size_t n) {
+    if (parts.size() != n + 1) {
+      throw std::runtime_error("Invalid key distribution '" + specification + "'");
+    }
+  };
+
+  if (parts[0] == "sequential") {
+    mType = Type::Sequential;
+    expectParameters(0);
+  } else if (parts[0] == "uniform") {
+    mType = Type::Uniform;
+    expectParameters(0);
+  } else if (parts[0] == "zipf") {
+    mType = Type::Zipf;
+    expectParameters(1);
+    auto skew = boost::lexical_cast<double>(parts[1]);
+    if (skew < 0) {
+      throw std::runtime_error("Zipf skew must not be negative");
+    }
+    std::vector<double> weights(keys);
+    for (size_t i = 0; i < keys; ++i) {
+      weights[i] = 1.0 / std::pow(double(i + 1), skew);
+    }
+    buildAliasTable(weights);
+  } else if (parts[0] == "hotspot") {
+    mType = Type::Hotspot;
+    expectParameters(2);
+    auto fraction = boost::lexical_cast<double>(parts[1]);
+    mHotProbability = boost::lexical_cast<double>(parts[2]);
+    if (fraction <= 0 || fraction > 1 || mHotProbability < 0 || mHotProbability > 1) {
+      throw std::runtime_error("Hotspot fraction must be in (0, 1], probability in [0, 1]");
+    }
+    mHotKeys = std::max<size_t>(1, size_t(fraction * keys));
+  } else {
+    throw std::runtime_error("Invalid key distribution '" + specification + "'");
+  }
+
+  if (mType != Type::Sequential) {
+    mPermutation.resize(keys);
+    std::iota(mPermutation.begin(), mPermutation.end(), 0);
+    std::shuffle(mPermutation.begin(), mPermutation.end(), std::mt19937_64(PERMUTATION_SEED));
+  }
+}
+
+void KeyDistribution::buildAliasTable(const std::vector<double>& weights)
+{
+  // Vose's alias method: every rank gets a column of height 1, split between itself and one alias
+  auto n = weights.size();
+  auto total = std::accumulate(weights.begin(), weights.end(), 0.0);
+  std::vector<double> scaled(n);
+  std::vector<uint32_t> small;
+  std::vector<uint32_t> large;
+  for (size_t i = 0; i < n; ++i) {
+    scaled[i] = weights[i] * double(n) / total;
+    (scaled[i] < 1.0 ? small : large).push_back(uint32_t(i));
+  }
+
+  mAliasProbabilities.assign(n, 1.0);
+  mAliases.resize(n);
+  std::iota(mAliases.begin(), mAliases.end(), 0);
+  while (!small.empty() && !large.empty()) {
+    auto less = small.back();
+    small.pop_back();
+    auto more = large.back();
+    mAliasProbabilities[less] = scaled[less];
+    mAliases[less] = more;
+    scaled[more] -= 1.0 - scaled[less];
+    if (scaled[more] < 1.0) {
+      large.pop_back();
+      small.push_back(more);
+    }
+  }
+  // Whatever remains has a column of height 1, up to rounding errors, which the initial values already cover
+}
+
+size_t KeyDistribution::pick(size_t request, std::mt19937_64& generator) const
+{
+  if (mKeys == 0) {
+    throw std::runtime_error("No keys to pick from");
+  }
+
+  size_t rank = 0;
+  switch (mType) {
+    case Type::Sequential:
+      return request % mKeys;
+    case Type::Uniform:
+      rank = std::uniform_int_distribution<size_t>(0, mKeys - 1)(generator);
+      break;
+    case Type::Zipf: {
+      auto column = std::uniform_int_distribution<size_t>(0, mKeys - 1)(generator);
+      auto keep = std::uniform_real_distribution<double>(0.0, 1.0)(generator) < mAliasProbabilities[column];
+      rank = keep ? column : mAliases[column];
+      break;
+    }
+    case Type::Hotspot:
+      if (mHotKeys == mKeys || std::uniform_real_distribution<double>(0.0, 1.0)(generator) < mHotProbability) {
+        rank = std::uniform_int_distribution<size_t>(0, mHotKeys - 1)(generator);
+      } else {
+        rank = std::uniform_int_distribution<size_t>(mHotKeys, mKeys - 1)(generator);
+      }
+      break;
+  }
+  return mPermutation[rank];
+}
+
+} // namespace ConfigurationBenchmark
+} // namespace AliceO2
@@ -0,0 +1,63 @@
+/// \file KeyDistribution.h
+/// \brief Definition of the KeyDistribution class, which picks the keys to request.
+
+#ifndef ALICEO2_CONFIGURATIONBENCHMARK_KEYDISTRIBUTION_H
+#define ALICEO2_CONFIGURATIONBENCHMARK_KEYDISTRIBUTION_H
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace AliceO2
+{
+namespace ConfigurationBenchmark
+{
+
+/// Distribution of the indexes of the keys to request, parsed from a specification:
+///   "sequential": every key in order, wrapping around
+///   "uniform": uniformly random keys
+///   "zipf:S": Zipfian with skew S, where the k-th most popular key is requested with a probability proportional to
+///     1 / k^S
+///   "hotspot:FRACTION:PROBABILITY": a hot set of the given fraction of the keys gets the given probability of the
+///     requests, uniformly within the hot and the cold set
+///
+/// Sampling is O(1): Zipf uses a precomputed alias table (Walker/Vose), the others are uniform draws. Popularity ranks
+/// are mapped to keys with a fixed pseudo-random permutation, so hot keys are scattered over the key space, and are
+/// the same in every process. Immutable once built, so the clients of a process share one, each drawing with its own
+/// generator.
+class KeyDistribution
+{
+  public:
+    KeyDistribution(const std::string& specification, size_t keys);
+
+    /// Index of the key to request
+    /// \param request Number of the request of the client, which the sequential distribution follows
+    size_t pick(size_t request, std::mt19937_64& generator) const;
+
+    bool isSequential() const
+    {
+      return mType == Type::Sequential;
+    }
+
+  private:
+    enum class Type
+    {
+      Sequential, Uniform, Zipf, Hotspot
+    };
+
+    void buildAliasTable(const std::vector<double>& weights);
+
+    Type mType;
+    size_t mKeys;
+    size_t mHotKeys; ///< Size of the hot set of the hotspot distribution
+    double mHotProbability;
+    std::vector<double> mAliasProbabilities; ///< Probability of keeping the drawn rank instead of taking its alias
+    std::vector<uint32_t> mAliases;
+    std::vector<uint32_t> mPermutation; ///< Popularity rank to key index
+};
+
+} // namespace ConfigurationBenchmark
+} // namespace AliceO2
+
+#endif // ALICEO2_CONFIGURATIONBENCHMARK_KEYDISTRIBUTION_H
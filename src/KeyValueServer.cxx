@@ -0,0 +1,793 @@
+/// \file KeyValueServer.cxx
+/// \brief Implementation of the KeyValueServer class.
+
+#include "KeyValueServer.h"
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <boost/algorithm/string.hpp>
+#include "Clock.h"
+#include "Encoding.h"
+
+namespace AliceO2
+{
+namespace ConfigurationBenchmark
+{
+namespace
+{
+constexpr size_t MAX_HEADER_SIZE = 64 * 1024;
+constexpr uint64_t DEFAULT_CONSUL_WAIT = 300000000000; ///< 5 minutes, like Consul
+constexpr uint64_t MAX_CONSUL_WAIT = 600000000000; ///< 10 minutes, like Consul
+const std::string CONSUL_PREFIX = "/v1/kv/";
+
+std::string urlDecode(const std::string& input, bool plusIsSpace)
+{
+  std::string output;
+  output.reserve(input.size());
+  for (size_t i = 0; i < input.size(); ++i) {
+    if (input[i] == '%' && i + 2 < input.size()) {
+      output += char(std::stoi(input.substr(i + 1, 2), nullptr, 16));
+      i += 2;
+    } else if (input[i] == '+' && plusIsSpace) {
+      output += ' ';
+    } else {
+      output += input[i];
+    }
+  }
+  return output;
+}
+
+/// Keys are stored without leading slashes, Consul does not use them while etcd does
+std::string canonicalKey(const std::string& key)
+{
+  auto start = key.find_first_not_of('/');
+  return start == std::string::npos ? "" : key.substr(start);
+}
+
+const char* statusText(int status)
+{
+  switch (status) {
+    case 100: return "Continue";
+    case 200: return "OK";
+    case 201: return "Created";
+    case 400: return "Bad Request";
+    case 404: return "Not Found";
+    case 405: return "Method Not Allowed";
+    default: return "Internal Server Error";
+  }
+}
+
+/// Directory structure for etcd v2 recursive responses
+struct EtcdNode
+{
+    std::map<std::string, EtcdNode> children;
+    bool hasValue = false;
+    std::string value;
+};
+
+void writeEtcdNode(const std::string& key, const EtcdNode& node, uint64_t index, bool recursive, std::string& out)
+{
+  out += "{\"key\":" + jsonString("/" + key);
+  if (node.hasValue) {
+    out += ",\"value\":" + jsonString(node.value);
+  } else {
+    out += ",\"dir\":true";
+    if (recursive || !node.children.empty()) {
+      out += ",\"nodes\":[";
+      bool first = true;
+      for (const auto& child : node.children) {
+        out += first ? "" : ",";
+        first = false;
+        auto childKey = key.empty() ? child.first : key + "/" + child.first;
+        if (recursive || child.second.hasValue) {
+          writeEtcdNode(childKey, child.second, index, recursive, out);
+        } else {
+          out += "{\"key\":" + jsonString("/" + childKey) + ",\"dir\":true,\"modifiedIndex\":" + std::to_string(index)
+              + ",\"createdIndex\":" + std::to_string(index) + "}";
+        }
+      }
+      out += "]";
+    }
+  }
+  out += ",\"modifiedIndex\":" + std::to_string(index) + ",\"createdIndex\":" + std::to_string(index) + "}";
+}
+
+/// Per-connection buffers
+struct Connection
+{
+    std::string input;
+    std::string output;
+    bool continueSent = false;
+    bool close = false;
+    bool blocked = false; ///< Waiting for a write to answer a blocking query, later requests wait behind it
+    KeyValueServer::Request blockedRequest;
+    uint64_t blockedIndex = 0; ///< Index given by the blocking query
+    uint64_t blockedDeadline = 0; ///< Monotonic time at which the blocking query is answered anyway
+};
+
+/// Parses a duration like Consul does, e.g. "500ms" or "10s"
+/// \return Nanoseconds
+uint64_t parseDuration(const std::string& duration)
+{
+  size_t unitStart = 0;
+  auto value = std::stod(duration, &unitStart);
+  auto unit = duration.substr(unitStart);
+  double scale = unit == "ns" ? 1.0 : unit == "us" ? 1e3 : unit == "ms" ? 1e6 : unit == "s" ? 1e9
+      : unit == "m" ? 60e9 : unit == "h" ? 3600e9 : 0.0;
+  if (scale == 0.0 || value < 0) {
+    throw std::runtime_error("Invalid duration '" + duration + "'");
+  }
+  return uint64_t(value * scale);
+}
+
+/// Reads the index and wait of a Consul blocking query
+/// \return False if the request is not a blocking query
+bool parseBlockingQuery(const KeyValueServer::Request& request, uint64_t& index, uint64_t& waitNanoseconds)
+{
+  auto indexParameter = request.query.find("index");
+  if (request.method != "GET" || !boost::starts_with(request.path, CONSUL_PREFIX)
+      || indexParameter == request.query.end()) {
+    return false;
+  }
+  index = std::stoull(indexParameter->second);
+  auto waitParameter = request.query.find("wait");
+  waitNanoseconds = waitParameter == request.query.end() ? DEFAULT_CONSUL_WAIT
+      : std::min(parseDuration(waitParameter->second), MAX_CONSUL_WAIT);
+  return true;
+}
+
+/// Parses one complete request from the start of the input buffer
+/// \return Number of bytes consumed, or 0 if the request is not complete yet
+size_t parseRequest(Connection& connection, KeyValueServer::Request& request)
+{
+  auto headerEnd = connection.input.find("\r\n\r\n");
+  if (headerEnd == std::string::npos) {
+    if (connection.input.size() > MAX_HEADER_SIZE) {
+      throw std::runtime_error("Request header too large");
+    }
+    return 0;
+  }
+
+  std::vector<std::string> lines;
+  boost::split(lines, connection.input.substr(0, headerEnd), boost::is_any_of("\n"));
+  std::vector<std::string> requestLine;
+  boost::split(requestLine, boost::trim_copy(lines[0]), boost::is_any_of(" "), boost::token_compress_on);
+  if (requestLine.size() < 2) {
+    throw std::runtime_error("Malformed request line");
+  }
+
+  request = KeyValueServer::Request();
+  request.method = requestLine[0];
+  for (size_t i = 1; i < lines.size(); ++i) {
+    auto colon = lines[i].find(':');
+    if (colon != std::string::npos) {
+      request.headers[boost::to_lower_copy(boost::trim_copy(lines[i].substr(0, colon)))] =
+          boost::trim_copy(lines[i].substr(colon + 1));
+    }
+  }
+
+  size_t contentLength = 0;
+  auto lengthHeader = request.headers.find("content-length");
+  if (lengthHeader != request.headers.end()) {
+    contentLength = std::stoul(lengthHeader->second);
+  }
+
+  auto bodyStart = headerEnd + 4;
+  if (connection.input.size() < bodyStart + contentLength) {
+    // curl waits for this before sending larger bodies
+    auto expect = request.headers.find("expect");
+    if (expect != request.headers.end() && boost::iequals(expect->second, "100-continue")
+        && !connection.continueSent) {
+      connection.output += "HTTP/1.1 100 Continue\r\n\r\n";
+      connection.continueSent = true;
+    }
+    return 0;
+  }
+  request.body = connection.input.substr(bodyStart, contentLength);
+  connection.continueSent = false;
+
+  const auto& target = requestLine[1];
+  auto queryStart = target.find('?');
+  request.path = urlDecode(target.substr(0, queryStart), false);
+  if (queryStart != std::string::npos) {
+    std::vector<std::string> pairs;
+    boost::split(pairs, target.substr(queryStart + 1), boost::is_any_of("&"), boost::token_compress_on);
+    for (const auto& pair : pairs) {
+      auto equals = pair.find('=');
+      request.query[urlDecode(pair.substr(0, equals), true)] =
+          equals == std::string::npos ? "" : urlDecode(pair.substr(equals + 1), true);
+    }
+  }
+
+  auto connectionHeader = request.headers.find("connection");
+  if (connectionHeader != request.headers.end() && boost::iequals(connectionHeader->second, "close")) {
+    connection.close = true;
+  }
+  if (requestLine.size() > 2 && requestLine[2] == "HTTP/1.0"
+      && (connectionHeader == request.headers.end() || !boost::iequals(connectionHeader->second, "keep-alive"))) {
+    connection.close = true;
+  }
+  return bodyStart + contentLength;
+}
+
+void writeResponse(const KeyValueServer::Response& response, bool close, std::string& out)
+{
+  out += "HTTP/1.1 " + std::to_string(response.status) + " " + statusText(response.status) + "\r\n";
+  out += "Content-Type: " + response.contentType + "\r\n";
+  out += "Content-Length: " + std::to_string(response.body.size()) + "\r\n";
+  for (const auto& header : response.headers) {
+    out += header.first + ": " + header.second + "\r\n";
+  }
+  out += close ? "Connection: close\r\n\r\n" : "\r\n";
+  out += response.body;
+}
+
+void setNonBlocking(int fd)
+{
+  fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+}
+} // Anonymous namespace
+
+KeyValueServer::KeyValueServer(std::shared_ptr<MockStore> store, const std::string& address, int port, int threads)
+    : mStore(store), mAddress(address), mPort(port), mThreads(std::max(1, threads)), mIndex(1), mBlocked(0)
+{
+}
+
+int KeyValueServer::createListener()
+{
+  int listener = socket(AF_INET, SOCK_STREAM, 0);
+  if (listener < 0) {
+    throw std::runtime_error(std::string("Failed to create socket: ") + strerror(errno));
+  }
+
+  int enable = 1;
+  setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+  setsockopt(listener, SOL_SOCKET, SO_REUSEPORT, &enable, sizeof(enable));
+
+  sockaddr_in address;
+  std::memset(&address, 0, sizeof(address));
+  address.sin_family = AF_INET;
+  address.sin_port = htons(uint16_t(mPort));
+  if (inet_pton(AF_INET, mAddress.c_str(), &address.sin_addr) != 1) {
+    throw std::runtime_error("Invalid address '" + mAddress + "'");
+  }
+  if (bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+    throw std::runtime_error(std::string("Failed to bind: ") + strerror(errno));
+  }
+  if (listen(listener, SOMAXCONN) != 0) {
+    throw std::runtime_error(std::string("Failed to listen: ") + strerror(errno));
+  }
+  setNonBlocking(listener);
+  return listener;
+}
+
+void KeyValueServer::run()
+{
+  // Create all listeners up front, so errors surface before any thread starts
+  std::vector<int> listeners;
+  for (int i = 0; i < mThreads; ++i) {
+    listeners.push_back(createListener());
+    mWakeups.push_back(eventfd(0, EFD_NONBLOCK));
+    if (mWakeups.back() < 0) {
+      throw std::runtime_error(std::string("Failed to create event file descriptor: ") + strerror(errno));
+    }
+  }
+
+  std::vector<std::thread> threads;
+  for (int i = 1; i < mThreads; ++i) {
+    threads.emplace_back([this, &listeners, i]{ serve(listeners[i], mWakeups[i]); });
+  }
+  serve(listeners[0], mWakeups[0]);
+}
+
+uint64_t KeyValueServer::advanceIndex(uint64_t writes)
+{
+  auto index = mIndex += writes;
+  // Checked after the index changed, while blocking queries are counted before they check the index, so a waiting
+  // query cannot miss the wakeup
+  if (mBlocked.load() > 0) {
+    uint64_t one = 1;
+    for (auto wakeup : mWakeups) {
+      if (::write(wakeup, &one, sizeof(one)) < 0) {
+        // The counter is full, so the thread will wake up anyway
+      }
+    }
+  }
+  return index;
+}
+
+void KeyValueServer::serve(int listener, int wakeup)
+{
+  int epoll = epoll_create1(0);
+  if (epoll < 0) {
+    throw std::runtime_error(std::string("Failed to create epoll instance: ") + strerror(errno));
+  }
+
+  epoll_event event;
+  std::memset(&event, 0, sizeof(event));
+  event.events = EPOLLIN;
+  event.data.fd = listener;
+  epoll_ctl(epoll, EPOLL_CTL_ADD, listener, &event);
+  event.data.fd = wakeup;
+  epoll_ctl(epoll, EPOLL_CTL_ADD, wakeup, &event);
+
+  std::unordered_map<int, Connection> connections;
+  std::set<int> blocked; ///< Connections with a blocking query
+  std::vector<epoll_event> events(256);
+  std::vector<char> buffer(64 * 1024);
+  Request request;
+
+  auto unblock = [&](int fd, Connection& connection) {
+    connection.blocked = false;
+    blocked.erase(fd);
+    mBlocked--;
+  };
+
+  auto closeConnection = [&](int fd) {
+    auto& connection = connections[fd];
+    if (connection.blocked) {
+      unblock(fd, connection);
+    }
+    epoll_ctl(epoll, EPOLL_CTL_DEL, fd, nullptr);
+    ::close(fd);
+    connections.erase(fd);
+  };
+
+  // Handles all complete requests, clients may pipeline them. A blocking query without a write after its index
+  // blocks the connection, until a write or its deadline.
+  auto process = [&](int fd, Connection& connection) {
+    try {
+      while (!connection.close && !connection.blocked) {
+        auto consumed = parseRequest(connection, request);
+        if (consumed == 0) {
+          break;
+        }
+        connection.input.erase(0, consumed);
+
+        uint64_t index, waitNanoseconds;
+        if (parseBlockingQuery(request, index, waitNanoseconds)) {
+          mBlocked++;
+          if (index >= mIndex.load()) {
+            connection.blocked = true;
+            connection.blockedRequest = request;
+            connection.blockedIndex = index;
+            connection.blockedDeadline = Clock::now() + waitNanoseconds;
+            blocked.insert(fd);
+            break;
+          }
+          mBlocked--;
+        }
+        writeResponse(handle(request), connection.close, connection.output);
+      }
+    } catch (const std::exception& e) {
+      Response response;
+      response.status = 400;
+      response.contentType = "text/plain";
+      response.body = e.what();
+      connection.close = true;
+      writeResponse(response, true, connection.output);
+    }
+  };
+
+  // Sends as much pending output as the socket takes, and only asks for EPOLLOUT while output is left
+  auto flush = [&](int fd, Connection& connection) {
+    while (!connection.output.empty()) {
+      auto sent = ::send(fd, connection.output.data(), connection.output.size(), MSG_NOSIGNAL);
+      if (sent < 0) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+          break;
+        }
+        return false;
+      }
+      connection.output.erase(0, size_t(sent));
+    }
+    epoll_event update;
+    std::memset(&update, 0, sizeof(update));
+    update.events = connection.output.empty() ? uint32_t(EPOLLIN) : uint32_t(EPOLLIN | EPOLLOUT);
+    update.data.fd = fd;
+    epoll_ctl(epoll, EPOLL_CTL_MOD, fd, &update);
+    return !(connection.close && connection.output.empty());
+  };
+
+  for (;;) {
+    // Wakes up for the earliest deadline of the blocking queries
+    int timeout = -1;
+    if (!blocked.empty()) {
+      auto deadline = connections[*blocked.begin()].blockedDeadline;
+      for (auto fd : blocked) {
+        deadline = std::min(deadline, connections[fd].blockedDeadline);
+      }
+      auto now = Clock::now();
+      timeout = deadline > now ? int((deadline - now + 999999) / 1000000) : 0;
+    }
+    int ready = epoll_wait(epoll, events.data(), int(events.size()), timeout);
+    if (ready < 0 && errno != EINTR) {
+      throw std::runtime_error(std::string("epoll_wait failed: ") + strerror(errno));
+    }
+
+    for (int i = 0; i < ready; ++i) {
+      int fd = events[i].data.fd;
+
+      if (fd == wakeup) {
+        uint64_t count;
+        while (::read(wakeup, &count, sizeof(count)) > 0) {
+        }
+        continue;
+      }
+
+      if (fd == listener) {
+        for (;;) {
+          int client = accept(listener, nullptr, nullptr);
+          if (client < 0) {
+            break;
+          }
+          setNonBlocking(client);
+          int enable = 1;
+          setsockopt(client, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+          epoll_event clientEvent;
+          std::memset(&clientEvent, 0, sizeof(clientEvent));
+          clientEvent.events = EPOLLIN;
+          clientEvent.data.fd = client;
+          epoll_ctl(epoll, EPOLL_CTL_ADD, client, &clientEvent);
+          connections[client];
+        }
+        continue;
+      }
+
+      auto& connection = connections[fd];
+      bool open = true;
+
+      if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+        for (;;) {
+          auto received = ::recv(fd, buffer.data(), buffer.size(), 0);
+          if (received > 0) {
+            connection.input.append(buffer.data(), size_t(received));
+          } else if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+          } else {
+            open = false; // Closed by the client, or an error
+            break;
+          }
+        }
+
+        process(fd, connection);
+      }
+
+      if (open) {
+        open = flush(fd, connection);
+      }
+      if (!open) {
+        closeConnection(fd);
+      }
+    }
+
+    // Answers the blocking queries that saw a write or reached their deadline
+    if (!blocked.empty()) {
+      auto index = mIndex.load();
+      auto now = Clock::now();
+      std::vector<int> answered;
+      for (auto fd : blocked) {
+        const auto& connection = connections[fd];
+        if (index > connection.blockedIndex || now >= connection.blockedDeadline) {
+          answered.push_back(fd);
+        }
+      }
+      for (auto fd : answered) {
+        auto& connection = connections[fd];
+        unblock(fd, connection);
+        writeResponse(handle(connection.blockedRequest), connection.close, connection.output);
+        process(fd, connection);
+        if (!flush(fd, connection)) {
+          closeConnection(fd);
+        }
+      }
+    }
+  }
+}
+
+auto KeyValueServer::handle(const Request& request) -> Response
+{
+  try {
+    static const std::string etcdV2Prefix = "/v2/keys";
+
+    if (request.path == "/v1/txn") {
+      return handleConsulTransaction(request);
+    }
+    if (boost::starts_with(request.path, CONSUL_PREFIX)) {
+      return handleConsul(request, request.path.substr(CONSUL_PREFIX.size()));
+    }
+    if (boost::starts_with(request.path, etcdV2Prefix)) {
+      return handleEtcdV2(request, canonicalKey(request.path.substr(etcdV2Prefix.size())));
+    }
+    for (const auto& prefix : {"/v3/kv/", "/v3beta/kv/", "/v3alpha/kv/"}) {
+      if (boost::starts_with(request.path, prefix)) {
+        return handleEtcdV3(request, request.path.substr(std::strlen(prefix)));
+      }
+    }
+
+    Response response;
+    response.status = 404;
+    response.contentType = "text/plain";
+    response.body = "Unsupported endpoint";
+    return response;
+  } catch (const std::exception& e) {
+    Response response;
+    response.status = 500;
+    response.contentType = "text/plain";
+    response.body = e.what();
+    return response;
+  }
+}
+
+auto KeyValueServer::handleConsul(const Request& request, const std::string& key) -> Response
+{
+  Response response;
+  auto index = std::to_string(mIndex.load());
+  response.headers["X-Consul-Index"] = index;
+  response.headers["X-Consul-Knownleader"] = "true";
+  response.headers["X-Consul-Lastcontact"] = "0";
+
+  auto entry = [&](const std::string& entryKey, const std::string& value) {
+    return "{\"LockIndex\":0,\"Key\":" + jsonString(entryKey) + ",\"Flags\":0,\"Value\":" + jsonString(
+        base64Encode(value)) + ",\"CreateIndex\":" + index + ",\"ModifyIndex\":" + index + "}";
+  };
+
+  if (request.method == "GET") {
+    if (request.query.count("recurse") || request.query.count("keys")) {
+      auto keyValues = mStore->getWithPrefix(key);
+      if (keyValues.empty()) {
+        response.status = 404;
+        return response;
+      }
+      response.body = "[";
+      for (size_t i = 0; i < keyValues.size(); ++i) {
+        response.body += i == 0 ? "" : ",";
+        response.body += request.query.count("keys") ? jsonString(keyValues[i].first)
+            : entry(keyValues[i].first, keyValues[i].second);
+      }
+      response.body += "]";
+    } else if (auto value = mStore->get(key)) {
+      if (request.query.count("raw")) {
+        response.contentType = "text/plain";
+        response.body = *value;
+      } else {
+        response.body = "[" + entry(key, *value) + "]";
+      }
+    } else {
+      response.status = 404;
+    }
+  } else if (request.method == "PUT") {
+    mStore->put(key, request.body);
+    advanceIndex(1);
+    response.body = "true";
+  } else if (request.method == "DELETE") {
+    if (request.query.count("recurse")) {
+      for (const auto& kv : mStore->getWithPrefix(key)) {
+        mStore->remove(kv.first);
+      }
+    } else {
+      mStore->remove(key);
+    }
+    advanceIndex(1);
+    response.body = "true";
+  } else {
+    response.status = 405;
+  }
+  return response;
+}
+
+auto KeyValueServer::handleConsulTransaction(const Request& request) -> Response
+{
+  Response response;
+  if (request.method != "PUT") {
+    response.status = 405;
+    return response;
+  }
+
+  // Operations look like {"KV":{"Verb":"set","Key":"KEY","Value":"BASE64"}}, only "set" is supported
+  std::vector<std::pair<std::string, std::string>> keyValues;
+  size_t position = 0;
+  for (auto verb = jsonStringField(request.body, "Verb", &position); position != std::string::npos;
+      verb = jsonStringField(request.body, "Verb", &position)) {
+    if (verb != "set") {
+      response.status = 400;
+      response.contentType = "text/plain";
+      response.body = "Unsupported transaction verb '" + verb + "'";
+      return response;
+    }
+    auto key = jsonStringField(request.body, "Key", &position);
+    auto value = base64Decode(jsonStringField(request.body, "Value", &position));
+    if (position == std::string::npos) {
+      response.status = 400;
+      response.contentType = "text/plain";
+      response.body = "Transaction operation without key or value";
+      return response;
+    }
+    keyValues.emplace_back(canonicalKey(key), std::move(value));
+  }
+
+  for (const auto& kv : keyValues) {
+    mStore->put(kv.first, kv.second);
+  }
+  auto index = std::to_string(advanceIndex(keyValues.size()));
+  response.headers["X-Consul-Index"] = index;
+
+  response.body = "{\"Results\":[";
+  for (size_t i = 0; i < keyValues.size(); ++i) {
+    response.body += i == 0 ? "" : ",";
+    response.body += "{\"KV\":{\"LockIndex\":0,\"Key\":" + jsonString(keyValues[i].first)
+        + ",\"Flags\":0,\"Value\":null,\"CreateIndex\":" + index + ",\"ModifyIndex\":" + index + "}}";
+  }
+  response.body += "],\"Errors\":null}";
+  return response;
+}
+
+auto KeyValueServer::handleEtcdV2(const Request& request, const std::string& key) -> Response
+{
+  Response response;
+  auto index = mIndex.load();
+  response.headers["X-Etcd-Index"] = std::to_string(index);
+
+  auto notFound = [&] {
+    response.status = 404;
+    response.body = "{\"errorCode\":100,\"message\":\"Key not found\",\"cause\":" + jsonString("/" + key)
+        + ",\"index\":" + std::to_string(index) + "}";
+    return response;
+  };
+
+  if (request.method == "GET") {
+    EtcdNode root;
+    if (auto value = mStore->get(key)) {
+      root.hasValue = true;
+      root.value = *value;
+    } else {
+      auto prefix = key.empty() ? key : key + "/";
+      auto keyValues = mStore->getWithPrefix(prefix);
+      if (keyValues.empty() && !key.empty()) {
+        return notFound();
+      }
+      std::vector<std::string> segments;
+      for (const auto& kv : keyValues) {
+        boost::split(segments, kv.first.substr(prefix.size()), boost::is_any_of("/"), boost::token_compress_on);
+        auto node = &root;
+        for (const auto& segment : segments) {
+          node = &node->children[segment];
+        }
+        node->hasValue = true;
+        node->value = kv.second;
+      }
+    }
+    response.body = "{\"action\":\"get\",\"node\":";
+    bool recursive = request.query.count("recursive") && request.query.at("recursive") == "true";
+    writeEtcdNode(key, root, index, recursive, response.body);
+    response.body += "}";
+  } else if (request.method == "PUT") {
+    // The value is sent as a form field, or otherwise as a query parameter
+    std::string value;
+    std::vector<std::string> fields;
+    boost::split(fields, request.body, boost::is_any_of("&"), boost::token_compress_on);
+    for (const auto& field : fields) {
+      if (boost::starts_with(field, "value=")) {
+        value = urlDecode(field.substr(6), true);
+      }
+    }
+    if (value.empty() && request.query.count("value")) {
+      value = request.query.at("value");
+    }
+    mStore->put(key, value);
+    index = advanceIndex(1);
+    EtcdNode node;
+    node.hasValue = true;
+    node.value = value;
+    response.status = 201;
+    response.body = "{\"action\":\"set\",\"node\":";
+    writeEtcdNode(key, node, index, false, response.body);
+    response.body += "}";
+  } else if (request.method == "DELETE") {
+    if (!mStore->get(key)) {
+      return notFound();
+    }
+    mStore->remove(key);
+    index = advanceIndex(1);
+    response.body = "{\"action\":\"delete\",\"node\":{\"key\":" + jsonString("/" + key) + ",\"modifiedIndex\":"
+        + std::to_string(index) + "}}";
+  } else {
+    response.status = 405;
+  }
+  return response;
+}
+
+auto KeyValueServer::handleEtcdV3(const Request& request, const std::string& operation) -> Response
+{
+  Response response;
+  if (request.method != "POST") {
+    response.status = 405;
+    return response;
+  }
+
+  auto revision = std::to_string(mIndex.load());
+  auto header = "\"header\":{\"cluster_id\":\"1\",\"member_id\":\"1\",\"revision\":\"" + revision
+      + "\",\"raft_term\":\"1\"}";
+  auto key = canonicalKey(base64Decode(jsonStringField(request.body, "key")));
+
+  if (operation == "range") {
+    auto rangeEnd = base64Decode(jsonStringField(request.body, "range_end"));
+    std::vector<std::pair<std::string, std::string>> keyValues;
+    if (rangeEnd.empty()) {
+      if (auto value = mStore->get(key)) {
+        keyValues.emplace_back(key, *value);
+      }
+    } else {
+      // A range end of "\0" means all keys from the given key onwards
+      keyValues = mStore->getRange(key, rangeEnd == std::string(1, '\0') ? "" : canonicalKey(rangeEnd));
+    }
+
+    response.body = "{" + header;
+    if (!keyValues.empty()) {
+      response.body += ",\"kvs\":[";
+      for (size_t i = 0; i < keyValues.size(); ++i) {
+        response.body += i == 0 ? "{" : ",{";
+        response.body += "\"key\":\"" + base64Encode(keyValues[i].first) + "\",\"create_revision\":\"" + revision
+            + "\",\"mod_revision\":\"" + revision + "\",\"version\":\"1\",\"value\":\""
+            + base64Encode(keyValues[i].second) + "\"}";
+      }
+      response.body += "],\"count\":\"" + std::to_string(keyValues.size()) + "\"";
+    }
+    response.body += "}";
+  } else if (operation == "put") {
+    mStore->put(key, base64Decode(jsonStringField(request.body, "value")));
+    advanceIndex(1);
+    response.body = "{" + header + "}";
+  } else if (operation == "txn") {
+    // Only unconditional puts are supported: {"success":[{"requestPut":{"key":"BASE64","value":"BASE64"}}]}
+    std::vector<std::pair<std::string, std::string>> keyValues;
+    size_t position = 0;
+    while (true) {
+      position = request.body.find("\"requestPut\"", position);
+      if (position == std::string::npos) {
+        break;
+      }
+      auto putKey = canonicalKey(base64Decode(jsonStringField(request.body, "key", &position)));
+      auto putValue = base64Decode(jsonStringField(request.body, "value", &position));
+      if (position == std::string::npos) {
+        response.status = 400;
+        response.contentType = "text/plain";
+        response.body = "Transaction put without key or value";
+        return response;
+      }
+      keyValues.emplace_back(std::move(putKey), std::move(putValue));
+    }
+
+    for (const auto& kv : keyValues) {
+      mStore->put(kv.first, kv.second);
+    }
+    advanceIndex(keyValues.size());
+
+    response.body = "{" + header + ",\"succeeded\":true,\"responses\":[";
+    for (size_t i = 0; i < keyValues.size(); ++i) {
+      response.body += i == 0 ? "{\"response_put\":{}}" : ",{\"response_put\":{}}";
+    }
+    response.body += "]}";
+  } else {
+    response.status = 404;
+    response.contentType = "text/plain";
+    response.body = "Unsupported etcd v3 operation";
+  }
+  return response;
+}
+
+} // namespace ConfigurationBenchmark
+} // namespace AliceO2
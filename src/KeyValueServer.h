@@ -0,0 +1,84 @@
+/// \file KeyValueServer.h
+/// \brief Definition of the KeyValueServer class, a stand-in for Consul and etcd servers.
+
+#ifndef ALICEO2_CONFIGURATIONBENCHMARK_KEYVALUESERVER_H
+#define ALICEO2_CONFIGURATIONBENCHMARK_KEYVALUESERVER_H
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "MockStore.h"
+
+namespace AliceO2
+{
+namespace ConfigurationBenchmark
+{
+
+/// HTTP/1.1 server for the key-value subset of the Consul and etcd APIs, backed by a MockStore.
+///
+/// Supported endpoints:
+///   Consul:   GET, PUT and DELETE on /v1/kv/KEY, with the 'recurse', 'keys' and 'raw' query parameters, and
+///             blocking queries with 'index' and 'wait'. These return on any write, not only on writes under the key.
+///             PUT on /v1/txn with "set" operations
+///   etcd v2:  GET, PUT and DELETE on /v2/keys/KEY, with the 'recursive' query parameter
+///   etcd v3:  POST on /v3/kv/range, /v3/kv/put and /v3/kv/txn of the JSON gateway (also under /v3beta and
+///             /v3alpha). Transactions only support unconditional puts.
+///
+/// Every thread has its own listening socket (SO_REUSEPORT) and epoll instance, so the kernel spreads the connections
+/// over the threads, and threads never share a connection.
+class KeyValueServer
+{
+  public:
+    KeyValueServer(std::shared_ptr<MockStore> store, const std::string& address, int port, int threads);
+
+    /// Serves requests, never returns
+    void run();
+
+    struct Request
+    {
+        std::string method;
+        std::string path; ///< Decoded path, without the query
+        std::map<std::string, std::string> query; ///< Decoded query parameters
+        std::map<std::string, std::string> headers; ///< Header names are lowercase
+        std::string body;
+    };
+
+    struct Response
+    {
+        int status = 200;
+        std::string contentType = "application/json";
+        std::map<std::string, std::string> headers;
+        std::string body;
+    };
+
+    /// Handles a single request. Exposed separately from the networking, so it can be used on its own.
+    Response handle(const Request& request);
+
+  private:
+    void serve(int listener, int wakeup);
+    int createListener();
+
+    /// Increases the modification index after writes, and wakes up the threads if blocking queries are waiting
+    /// \return The new index
+    uint64_t advanceIndex(uint64_t writes);
+
+    Response handleConsul(const Request& request, const std::string& key);
+    Response handleConsulTransaction(const Request& request);
+    Response handleEtcdV2(const Request& request, const std::string& key);
+    Response handleEtcdV3(const Request& request, const std::string& operation);
+
+    std::shared_ptr<MockStore> mStore;
+    std::string mAddress;
+    int mPort;
+    int mThreads;
+    std::atomic<uint64_t> mIndex; ///< Modification index, increased on every write
+    std::vector<int> mWakeups; ///< Event file descriptor per thread, to wake it up for its blocking queries
+    std::atomic<int> mBlocked; ///< Blocking queries waiting for a write, in all threads
+};
+
+} // namespace ConfigurationBenchmark
+} // namespace AliceO2
+
+#endif // ALICEO2_CONFIGURATIONBENCHMARK_KEYVALUESERVER_H
@@ -0,0 +1,251 @@
+/// \file MockConfiguration.cxx
+/// \brief Implementation of the MockConfiguration class.
+
+#include "MockConfiguration.h"
+#include <unistd.h>
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <stdexcept>
+#include <vector>
+#include <boost/algorithm/string.hpp>
+#include <boost/lexical_cast.hpp>
+#include "Clock.h"
+
+namespace AliceO2
+{
+namespace ConfigurationBenchmark
+{
+namespace
+{
+const std::string MOCK_SCHEME = "mock://";
+
+struct MockUri
+{
+    std::string name;
+    std::map<std::string, std::string> options;
+
+    template <typename T>
+    T getOption(const std::string& key, T defaultValue) const
+    {
+      auto iterator = options.find(key);
+      return iterator == options.end() ? defaultValue : boost::lexical_cast<T>(iterator->second);
+    }
+};
+
+MockUri parseUri(const std::string& uri)
+{
+  if (uri.compare(0, MOCK_SCHEME.size(), MOCK_SCHEME) != 0) {
+    throw std::runtime_error("Not a mock URI: '" + uri + "'");
+  }
+
+  MockUri parsed;
+  auto rest = uri.substr(MOCK_SCHEME.size());
+  auto query = rest.find('?');
+  parsed.name = rest.substr(0, query);
+
+  if (query != std::string::npos) {
+    std::vector<std::string> pairs;
+    boost::split(pairs, rest.substr(query + 1), boost::is_any_of("&"), boost::token_compress_on);
+    for (const auto& pair : pairs) {
+      auto equals = pair.find('=');
+      if (equals == std::string::npos) {
+        throw std::runtime_error("Invalid mock URI option '" + pair + "', expected 'key=value'");
+      }
+      parsed.options[pair.substr(0, equals)] = pair.substr(equals + 1);
+    }
+  }
+  return parsed;
+}
+
+constexpr int DEFAULT_SHARDS = 16;
+} // Anonymous namespace
+
+LatencyDistribution::LatencyDistribution()
+    : mType(Type::Fixed), mFirst(0), mSecond(0)
+{
+}
+
+LatencyDistribution::LatencyDistribution(const std::string& specification)
+    : mFirst(0), mSecond(0)
+{
+  std::vector<std::string> parts;
+  boost::split(parts, specification, boost::is_any_of(":"));
+
+  auto expectParameters = [&](size_t n) {
+    if (parts.size() != n + 1) {
+      throw std::runtime_error("Invalid latency distribution '" + specification + "'");
+    }
+    mFirst = boost::lexical_cast<double>(parts[1]);
+    mSecond = n > 1 ? boost::lexical_cast<double>(parts[2]) : 0.0;
+  };
+
+  if (parts[0] == "fixed") {
+    mType = Type::Fixed;
+    expectParameters(1);
+  } else if (parts[0] == "uniform") {
+    mType = Type::Uniform;
+    expectParameters(2);
+  } else if (parts[0] == "exponential") {
+    mType = Type::Exponential;
+    expectParameters(1);
+  } else if (parts[0] == "lognormal") {
+    mType = Type::LogNormal;
+    expectParameters(2);
+  } else {
+    throw std::runtime_error("Invalid latency distribution '" + specification + "'");
+  }
+}
+
+uint64_t LatencyDistribution::sample(std::mt19937_64& generator) const
+{
+  double micros = 0;
+  switch (mType) {
+    case Type::Fixed:
+      micros = mFirst;
+      break;
+    case Type::Uniform:
+      micros = std::uniform_real_distribution<double>(mFirst, mSecond)(generator);
+      break;
+    case Type::Exponential:
+      micros = mFirst > 0 ? std::exponential_distribution<double>(1.0 / mFirst)(generator) : 0.0;
+      break;
+    case Type::LogNormal:
+      micros = mFirst > 0 ? std::lognormal_distribution<double>(std::log(mFirst), mSecond)(generator) : 0.0;
+      break;
+  }
+  return uint64_t(std::max(0.0, micros) * 1000.0);
+}
+
+MockConfiguration::MockConfiguration(const std::string& uri)
+    : mStore(getStore(uri)), mBandwidth(0), mErrorRate(0),
+      mGenerator(std::random_device()() ^ (uint64_t(::getpid()) << 32) ^ Clock::now())
+{
+  auto parsed = parseUri(uri);
+  auto getLatency = parsed.getOption<std::string>("get-latency", "");
+  auto putLatency = parsed.getOption<std::string>("put-latency", "");
+  if (!getLatency.empty()) {
+    mGetLatency = LatencyDistribution(getLatency);
+  }
+  if (!putLatency.empty()) {
+    mPutLatency = LatencyDistribution(putLatency);
+  }
+  mBandwidth = parsed.getOption<double>("bandwidth", 0);
+  mErrorRate = parsed.getOption<double>("error-rate", 0);
+}
+
+bool MockConfiguration::isMockUri(const std::string& uri)
+{
+  return uri.compare(0, MOCK_SCHEME.size(), MOCK_SCHEME) == 0;
+}
+
+auto MockConfiguration::getStore(const std::string& uri) -> std::shared_ptr<MockStore>
+{
+  auto parsed = parseUri(uri);
+  return MockStore::get(parsed.name, parsed.getOption<int>("shards", DEFAULT_SHARDS),
+      parsed.getOption<double>("rate", 0));
+}
+
+bool MockConfiguration::simulate(const LatencyDistribution& latency, uint64_t bytes)
+{
+  auto start = std::max(mStore->reserveSlot(), Clock::now());
+  auto transfer = mBandwidth > 0 ? uint64_t(double(bytes) / mBandwidth * 1e9) : 0;
+  auto end = start + latency.sample(mGenerator) + transfer;
+  if (end > Clock::now()) {
+    Clock::sleepUntil(end);
+  }
+  return mErrorRate > 0 && std::uniform_real_distribution<double>(0.0, 1.0)(mGenerator) < mErrorRate;
+}
+
+void MockConfiguration::putString(const std::string& path, const std::string& value)
+{
+  auto key = mPrefix + path;
+  if (simulate(mPutLatency, key.size() + value.size())) {
+    throw std::runtime_error("Mock put failed for key '" + key + "'");
+  }
+  mStore->put(key, value);
+}
+
+void MockConfiguration::putBatch(const ParameterSet& parameters, size_t begin, size_t end)
+{
+  uint64_t bytes = 0;
+  for (auto i = begin; i != end; ++i) {
+    bytes += mPrefix.size() + parameters.key(i).size() + parameters.value(i).size();
+  }
+  if (simulate(mPutLatency, bytes)) {
+    throw std::runtime_error("Mock batch put failed");
+  }
+  for (auto i = begin; i != end; ++i) {
+    mStore->put(mPrefix + parameters.key(i).to_string(), parameters.value(i).to_string());
+  }
+}
+
+auto MockConfiguration::getString(const std::string& path) -> boost::optional<std::string>
+{
+  auto key = mPrefix + path;
+  auto value = mStore->get(key);
+  if (simulate(mGetLatency, key.size() + (value ? value->size() : 0))) {
+    return boost::none;
+  }
+  return value;
+}
+
+void MockConfiguration::setPrefix(const std::string& path)
+{
+  mPrefix = path;
+}
+
+void MockConfiguration::resetPrefix()
+{
+  mPrefix.clear();
+}
+
+auto MockConfiguration::getRecursive(const std::string& path) -> Configuration::Tree::Node
+{
+  using Configuration::Tree::Branch;
+  using Configuration::Tree::Leaf;
+  using Configuration::Tree::Node;
+
+  auto key = mPrefix + path;
+  if (auto value = mStore->get(key)) {
+    if (simulate(mGetLatency, key.size() + value->size())) {
+      throw std::runtime_error("Mock recursive get failed for key '" + key + "'");
+    }
+    return Node(Leaf(*value));
+  }
+
+  auto prefix = (key.empty() || key.back() == '/') ? key : key + '/';
+  auto keyValues = mStore->getWithPrefix(prefix);
+
+  uint64_t bytes = 0;
+  for (const auto& kv : keyValues) {
+    bytes += kv.first.size() + kv.second.size();
+  }
+  if (simulate(mGetLatency, bytes)) {
+    throw std::runtime_error("Mock recursive get failed for key '" + key + "'");
+  }
+
+  Node root = Branch();
+  std::vector<std::string> segments;
+  for (const auto& kv : keyValues) {
+    boost::split(segments, kv.first.substr(prefix.size()), boost::is_any_of("/"), boost::token_compress_on);
+    segments.erase(std::remove(segments.begin(), segments.end(), ""), segments.end());
+    if (segments.empty()) {
+      continue;
+    }
+
+    auto branch = &boost::get<Branch>(root);
+    for (size_t i = 0; i + 1 < segments.size(); ++i) {
+      auto& child = (*branch)[segments[i]];
+      if (!boost::get<Branch>(&child)) {
+        child = Branch();
+      }
+      branch = &boost::get<Branch>(child);
+    }
+    (*branch)[segments.back()] = Leaf(kv.second);
+  }
+  return root;
+}
+
+} // namespace ConfigurationBenchmark
+} // namespace AliceO2
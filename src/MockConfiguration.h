@@ -0,0 +1,92 @@
+/// \file MockConfiguration.h
+/// \brief Definition of the MockConfiguration class, an in-process stand-in for a configuration server.
+
+#ifndef ALICEO2_CONFIGURATIONBENCHMARK_MOCKCONFIGURATION_H
+#define ALICEO2_CONFIGURATIONBENCHMARK_MOCKCONFIGURATION_H
+
+#include <memory>
+#include <random>
+#include <string>
+#include <boost/optional.hpp>
+#include "Configuration/ConfigurationInterface.h"
+#include "MockStore.h"
+#include "ParameterSet.h"
+
+namespace AliceO2
+{
+namespace ConfigurationBenchmark
+{
+
+/// Random latency, parsed from a specification in microseconds:
+///   "fixed:MICROS", "uniform:MIN:MAX", "exponential:MEAN" or "lognormal:MEDIAN:SIGMA"
+class LatencyDistribution
+{
+  public:
+    LatencyDistribution();
+    explicit LatencyDistribution(const std::string& specification);
+
+    /// Draws a latency in nanoseconds
+    uint64_t sample(std::mt19937_64& generator) const;
+
+  private:
+    enum class Type
+    {
+      Fixed, Uniform, Exponential, LogNormal
+    };
+
+    Type mType;
+    double mFirst;
+    double mSecond;
+};
+
+/// ConfigurationInterface backed by a MockStore, with injected latency, bandwidth limits and errors.
+///
+/// URI format: "mock://NAME?OPTION=VALUE&OPTION=VALUE..." where the options are:
+///   get-latency, put-latency: LatencyDistribution specifications, default none
+///   bandwidth: bytes per second for transferring keys and values, default unlimited
+///   rate: maximum operations per second of the store, default unlimited
+///   error-rate: probability [0, 1] that an operation fails, default 0
+///   shards: number of shards of the store, default 16
+///
+/// Without options, it measures the overhead of the client side on its own.
+class MockConfiguration : public Configuration::ConfigurationInterface
+{
+  public:
+    explicit MockConfiguration(const std::string& uri);
+
+    virtual ~MockConfiguration()
+    {
+    }
+
+    static bool isMockUri(const std::string& uri);
+
+    /// Store used by the configurations with the given URI, to fill it without injected latency and errors
+    static auto getStore(const std::string& uri) -> std::shared_ptr<MockStore>;
+
+    virtual void putString(const std::string& path, const std::string& value);
+    virtual auto getString(const std::string& path) -> boost::optional<std::string>;
+    virtual void setPrefix(const std::string& path);
+    virtual void resetPrefix();
+    virtual auto getRecursive(const std::string& path = "") -> Configuration::Tree::Node;
+
+    /// Puts the entries [begin, end) of the set in a single simulated operation, like a transaction of a real backend
+    void putBatch(const ParameterSet& parameters, size_t begin, size_t end);
+
+  private:
+    /// Waits as long as the simulated server would take, and decides whether the operation fails
+    /// \return True if the operation should fail
+    bool simulate(const LatencyDistribution& latency, uint64_t bytes);
+
+    std::shared_ptr<MockStore> mStore;
+    std::string mPrefix;
+    LatencyDistribution mGetLatency;
+    LatencyDistribution mPutLatency;
+    double mBandwidth;
+    double mErrorRate;
+    std::mt19937_64 mGenerator;
+};
+
+} // namespace ConfigurationBenchmark
+} // namespace AliceO2
+
+#endif // ALICEO2_CONFIGURATIONBENCHMARK_MOCKCONFIGURATION_H
@@ -0,0 +1,147 @@
+/// \file MockStore.cxx
+/// \brief Implementation of the MockStore class.
+
+#include "MockStore.h"
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <stdexcept>
+#include "Clock.h"
+
+namespace AliceO2
+{
+namespace ConfigurationBenchmark
+{
+
+auto MockStore::get(const std::string& name, int shards, double operationsPerSecond) -> std::shared_ptr<MockStore>
+{
+  static std::mutex mutex;
+  static std::map<std::string, std::shared_ptr<MockStore>> stores;
+
+  std::lock_guard<std::mutex> lock(mutex);
+  auto& store = stores[name];
+  if (!store) {
+    store = std::make_shared<MockStore>(shards, operationsPerSecond);
+  }
+  return store;
+}
+
+MockStore::MockStore(int shards, double operationsPerSecond)
+    : mSlotNanoseconds(operationsPerSecond > 0 ? uint64_t(1e9 / operationsPerSecond) : 0), mNextSlot(0), mVersion(0),
+      mWaiters(0)
+{
+  if (shards < 1) {
+    throw std::runtime_error("Mock store needs at least one shard");
+  }
+  for (int i = 0; i < shards; ++i) {
+    mShards.push_back(std::make_unique<Shard>());
+  }
+}
+
+auto MockStore::getShard(const std::string& key) -> Shard&
+{
+  return *mShards[std::hash<std::string>()(key) % mShards.size()];
+}
+
+void MockStore::put(const std::string& key, const std::string& value)
+{
+  auto& shard = getShard(key);
+  {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    shard.map[key] = value;
+  }
+  modified();
+}
+
+auto MockStore::get(const std::string& key) -> boost::optional<std::string>
+{
+  auto& shard = getShard(key);
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  auto iterator = shard.map.find(key);
+  if (iterator == shard.map.end()) {
+    return boost::none;
+  }
+  return iterator->second;
+}
+
+void MockStore::remove(const std::string& key)
+{
+  auto& shard = getShard(key);
+  {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    shard.map.erase(key);
+  }
+  modified();
+}
+
+void MockStore::modified()
+{
+  mVersion++;
+  if (mWaiters.load() > 0) {
+    // Taking the mutex orders this after a waiter's version check, so the notification cannot be missed
+    std::lock_guard<std::mutex> lock(mChangeMutex);
+    mChange.notify_all();
+  }
+}
+
+uint64_t MockStore::version() const
+{
+  return mVersion.load();
+}
+
+uint64_t MockStore::waitForChange(uint64_t version, uint64_t timeoutNanoseconds)
+{
+  mWaiters++;
+  {
+    std::unique_lock<std::mutex> lock(mChangeMutex);
+    mChange.wait_for(lock, std::chrono::nanoseconds(timeoutNanoseconds), [&] { return mVersion.load() != version; });
+  }
+  mWaiters--;
+  return mVersion.load();
+}
+
+auto MockStore::getWithPrefix(const std::string& prefix) -> std::vector<std::pair<std::string, std::string>>
+{
+  // The end of the range is the prefix with its last byte incremented, dropping bytes that would overflow
+  std::string end = prefix;
+  while (!end.empty() && static_cast<unsigned char>(end.back()) == 0xff) {
+    end.pop_back();
+  }
+  if (!end.empty()) {
+    end.back()++;
+  }
+  return getRange(prefix, end);
+}
+
+auto MockStore::getRange(const std::string& begin, const std::string& end)
+    -> std::vector<std::pair<std::string, std::string>>
+{
+  std::vector<std::pair<std::string, std::string>> keyValues;
+  for (auto& shard : mShards) {
+    std::lock_guard<std::mutex> lock(shard->mutex);
+    auto last = end.empty() ? shard->map.end() : shard->map.lower_bound(end);
+    keyValues.insert(keyValues.end(), shard->map.lower_bound(begin), last);
+  }
+  // Every shard is sorted on its own, but not the concatenation
+  std::sort(keyValues.begin(), keyValues.end());
+  return keyValues;
+}
+
+uint64_t MockStore::reserveSlot()
+{
+  if (mSlotNanoseconds == 0) {
+    return 0;
+  }
+
+  // The store serves one operation per slot. A slot that was not used in time is lost, like an idle server.
+  auto now = Clock::now();
+  auto slot = mNextSlot.load();
+  uint64_t start;
+  do {
+    start = std::max(slot, now);
+  } while (!mNextSlot.compare_exchange_weak(slot, start + mSlotNanoseconds));
+  return start;
+}
+
+} // namespace ConfigurationBenchmark
+} // namespace AliceO2
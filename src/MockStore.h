@@ -0,0 +1,81 @@
+/// \file MockStore.h
+/// \brief Definition of the MockStore class, the in-memory store of the mock backend and the stand-in server.
+
+#ifndef ALICEO2_CONFIGURATIONBENCHMARK_MOCKSTORE_H
+#define ALICEO2_CONFIGURATIONBENCHMARK_MOCKSTORE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+#include <boost/optional.hpp>
+
+namespace AliceO2
+{
+namespace ConfigurationBenchmark
+{
+
+/// In-memory key-value store, sharded so concurrent clients rarely contend on the same lock.
+/// Stores are named and live as long as the process. Forked processes get a copy-on-write copy.
+class MockStore
+{
+  public:
+    /// \param shards Number of shards, only used if the store does not exist yet
+    /// \param operationsPerSecond Maximum throughput of the store, 0 for unlimited. Only used if the store does not
+    ///   exist yet.
+    static auto get(const std::string& name, int shards, double operationsPerSecond) -> std::shared_ptr<MockStore>;
+
+    MockStore(int shards, double operationsPerSecond);
+
+    void put(const std::string& key, const std::string& value);
+    auto get(const std::string& key) -> boost::optional<std::string>;
+
+    void remove(const std::string& key);
+
+    /// All key-values with keys that start with the given prefix, sorted by key
+    auto getWithPrefix(const std::string& prefix) -> std::vector<std::pair<std::string, std::string>>;
+
+    /// All key-values with keys in [begin, end), sorted by key. An empty end means no upper bound.
+    auto getRange(const std::string& begin, const std::string& end) -> std::vector<std::pair<std::string, std::string>>;
+
+    /// Number of modifications so far
+    uint64_t version() const;
+
+    /// Waits until the store was modified after the given version, or the timeout passed
+    /// \return The current version
+    uint64_t waitForChange(uint64_t version, uint64_t timeoutNanoseconds);
+
+    /// Reserves a time slot for one operation according to the throughput cap
+    /// \return Monotonic time at which the operation may start
+    uint64_t reserveSlot();
+
+  private:
+    struct Shard
+    {
+        std::mutex mutex;
+        std::map<std::string, std::string> map;
+    };
+
+    Shard& getShard(const std::string& key);
+
+    /// Increments the version and wakes up the waiters, if any
+    void modified();
+
+    std::vector<std::unique_ptr<Shard>> mShards;
+    uint64_t mSlotNanoseconds;
+    std::atomic<uint64_t> mNextSlot;
+    std::atomic<uint64_t> mVersion;
+    std::atomic<int> mWaiters; ///< So modifications only take the change mutex if someone is waiting
+    std::mutex mChangeMutex;
+    std::condition_variable mChange;
+};
+
+} // namespace ConfigurationBenchmark
+} // namespace AliceO2
+
+#endif // ALICEO2_CONFIGURATIONBENCHMARK_MOCKSTORE_H
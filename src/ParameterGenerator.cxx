@@ -0,0 +1,77 @@
+/// \file ParameterGenerator.cxx
+/// \brief Implementation of the ParameterGenerator classes.
+
+#include "ParameterGenerator.h"
+#include <limits>
+#include "Encoding.h"
+
+namespace AliceO2
+{
+namespace ConfigurationBenchmark
+{
+
+constexpr size_t ParameterGenerator::npos;
+
+StoredParameterGenerator::StoredParameterGenerator(std::shared_ptr<const ParameterSet> parameters)
+    : mParameters(std::move(parameters))
+{
+}
+
+size_t StoredParameterGenerator::size() const
+{
+  return mParameters->size();
+}
+
+Parameter StoredParameterGenerator::get(size_t index)
+{
+  return {mParameters->key(index), mParameters->value(index)};
+}
+
+size_t StoredParameterGenerator::find(boost::string_ref key) const
+{
+  return mParameters->find(key);
+}
+
+NumberedParameterGenerator::NumberedParameterGenerator(const std::string& keyPrefix, int nParameters,
+    const ValueGenerator& values)
+    : mKeyPrefix(keyPrefix), mSize(size_t(nParameters)), mValues(values)
+{
+}
+
+size_t NumberedParameterGenerator::size() const
+{
+  return mSize;
+}
+
+Parameter NumberedParameterGenerator::get(size_t index)
+{
+  mKey.assign(mKeyPrefix);
+  appendDecimal(index, 0, mKey);
+  mValue.clear();
+  mValues.append(int(index), mValue);
+  return {mKey, mValue};
+}
+
+size_t NumberedParameterGenerator::find(boost::string_ref key) const
+{
+  if (!key.starts_with(mKeyPrefix)) {
+    return npos;
+  }
+  key.remove_prefix(mKeyPrefix.size());
+
+  // The number must be written exactly as get() writes it, without sign or leading zeros
+  if (key.empty() || key.size() > std::numeric_limits<size_t>::digits10 || (key.size() > 1 && key[0] == '0')) {
+    return npos;
+  }
+  size_t index = 0;
+  for (char c : key) {
+    if (c < '0' || c > '9') {
+      return npos;
+    }
+    index = index * 10 + size_t(c - '0');
+  }
+  return index < mSize ? index : npos;
+}
+
+} // namespace ConfigurationBenchmark
+} // namespace AliceO2
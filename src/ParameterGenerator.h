@@ -0,0 +1,82 @@
+/// \file ParameterGenerator.h
+/// \brief Definition of the ParameterGenerator classes, which give the expected parameters one at a time.
+
+#ifndef ALICEO2_CONFIGURATIONBENCHMARK_PARAMETERGENERATOR_H
+#define ALICEO2_CONFIGURATIONBENCHMARK_PARAMETERGENERATOR_H
+
+#include <memory>
+#include <string>
+#include <boost/utility/string_ref.hpp>
+#include "ParameterSet.h"
+#include "ValueGenerator.h"
+
+namespace AliceO2
+{
+namespace ConfigurationBenchmark
+{
+
+/// Key and expected value of a parameter
+struct Parameter
+{
+    boost::string_ref key;
+    boost::string_ref value;
+};
+
+/// Gives the expected parameters by index, from 0 to size() - 1, so they can be requested and checked one at a time
+/// without knowing how they are stored. Not thread-safe, every client uses its own generator.
+class ParameterGenerator
+{
+  public:
+    static constexpr size_t npos = size_t(-1);
+
+    virtual ~ParameterGenerator()
+    {
+    }
+
+    virtual size_t size() const = 0;
+
+    /// \return The parameter with the index. It may point into buffers of the generator, so it is only valid until
+    ///   the next call.
+    virtual Parameter get(size_t index) = 0;
+
+    /// \return Index of the parameter with the key, or npos if there is none
+    virtual size_t find(boost::string_ref key) const = 0;
+};
+
+/// Gives the parameters of a ParameterSet, in sorted order, without copying them
+class StoredParameterGenerator : public ParameterGenerator
+{
+  public:
+    explicit StoredParameterGenerator(std::shared_ptr<const ParameterSet> parameters);
+
+    virtual size_t size() const;
+    virtual Parameter get(size_t index);
+    virtual size_t find(boost::string_ref key) const;
+
+  private:
+    std::shared_ptr<const ParameterSet> mParameters;
+};
+
+/// Generates the parameters on demand, for structures where the key of a parameter is a prefix followed by its
+/// number, which is also its index. Uses no memory per parameter, so there is nothing to generate up front.
+class NumberedParameterGenerator : public ParameterGenerator
+{
+  public:
+    NumberedParameterGenerator(const std::string& keyPrefix, int nParameters, const ValueGenerator& values);
+
+    virtual size_t size() const;
+    virtual Parameter get(size_t index);
+    virtual size_t find(boost::string_ref key) const;
+
+  private:
+    std::string mKeyPrefix;
+    size_t mSize;
+    ValueGenerator mValues;
+    std::string mKey; ///< Buffer for the key of the last parameter
+    std::string mValue; ///< Buffer for the value of the last parameter
+};
+
+} // namespace ConfigurationBenchmark
+} // namespace AliceO2
+
+#endif // ALICEO2_CONFIGURATIONBENCHMARK_PARAMETERGENERATOR_H
@@ -0,0 +1,58 @@
+/// \file ParameterSet.cxx
+/// \brief Implementation of the ParameterSet class.
+
+#include "ParameterSet.h"
+#include <algorithm>
+
+namespace AliceO2
+{
+namespace ConfigurationBenchmark
+{
+
+constexpr size_t ParameterSet::npos;
+
+void ParameterSet::reserve(size_t entries, size_t bytes)
+{
+  mEntries.reserve(entries);
+  mArena.reserve(bytes);
+}
+
+void ParameterSet::add(StringRef key, StringRef value)
+{
+  emplace([&](std::string& arena) { arena.append(key.data(), key.size()); },
+      [&](std::string& arena) { arena.append(value.data(), value.size()); });
+}
+
+void ParameterSet::sort()
+{
+  auto keyOf = [&](const Entry& entry) { return StringRef(mArena.data() + entry.keyOffset, entry.keyLength); };
+
+  std::stable_sort(mEntries.begin(), mEntries.end(),
+      [&](const Entry& a, const Entry& b) { return keyOf(a) < keyOf(b); });
+  mEntries.erase(std::unique(mEntries.begin(), mEntries.end(),
+      [&](const Entry& a, const Entry& b) { return keyOf(a) == keyOf(b); }), mEntries.end());
+  mEntries.shrink_to_fit();
+}
+
+size_t ParameterSet::find(StringRef key) const
+{
+  size_t low = 0;
+  size_t high = mEntries.size();
+  while (low < high) {
+    auto middle = low + (high - low) / 2;
+    if (this->key(middle) < key) {
+      low = middle + 1;
+    } else {
+      high = middle;
+    }
+  }
+  return (low < mEntries.size() && this->key(low) == key) ? low : npos;
+}
+
+size_t ParameterSet::memoryUsage() const
+{
+  return mArena.capacity() + mEntries.capacity() * sizeof(Entry);
+}
+
+} // namespace ConfigurationBenchmark
+} // namespace AliceO2
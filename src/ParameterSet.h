@@ -0,0 +1,97 @@
+/// \file ParameterSet.h
+/// \brief Definition of the ParameterSet class, flat storage for the generated parameters.
+
+#ifndef ALICEO2_CONFIGURATIONBENCHMARK_PARAMETERSET_H
+#define ALICEO2_CONFIGURATIONBENCHMARK_PARAMETERSET_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <boost/utility/string_ref.hpp>
+
+namespace AliceO2
+{
+namespace ConfigurationBenchmark
+{
+
+/// Key-values stored in one contiguous arena, with an index of offsets sorted by key. Generating a million parameters
+/// takes two allocations instead of two million, and the set can be shared copy-on-write by forked processes, since
+/// it holds no pointers.
+///
+/// Entries are added with emplace() or add(), then sort() makes the set usable. Keys and values are accessed as
+/// string_refs into the arena, which stay valid as long as the set is not modified.
+class ParameterSet
+{
+  public:
+    using StringRef = boost::string_ref;
+
+    static constexpr size_t npos = size_t(-1);
+
+    /// Reserves room for the entries and the bytes of their keys and values
+    void reserve(size_t entries, size_t bytes);
+
+    /// Adds an entry, written directly into the arena by the two functions, which are called with the arena as a
+    /// std::string& and must only append to it
+    template <typename KeyWriter, typename ValueWriter>
+    void emplace(KeyWriter writeKey, ValueWriter writeValue)
+    {
+      Entry entry;
+      entry.keyOffset = mArena.size();
+      writeKey(mArena);
+      entry.keyLength = uint32_t(mArena.size() - entry.keyOffset);
+      entry.valueOffset = mArena.size();
+      writeValue(mArena);
+      entry.valueLength = uint32_t(mArena.size() - entry.valueOffset);
+      mEntries.push_back(entry);
+    }
+
+    void add(StringRef key, StringRef value);
+
+    /// Sorts the entries by key, and drops duplicate keys, keeping the first one added
+    void sort();
+
+    size_t size() const
+    {
+      return mEntries.size();
+    }
+
+    bool empty() const
+    {
+      return mEntries.empty();
+    }
+
+    StringRef key(size_t index) const
+    {
+      const auto& entry = mEntries[index];
+      return StringRef(mArena.data() + entry.keyOffset, entry.keyLength);
+    }
+
+    StringRef value(size_t index) const
+    {
+      const auto& entry = mEntries[index];
+      return StringRef(mArena.data() + entry.valueOffset, entry.valueLength);
+    }
+
+    /// \return Index of the key, or npos if it is not in the set. Requires a sorted set.
+    size_t find(StringRef key) const;
+
+    /// Bytes used by the arena and the index
+    size_t memoryUsage() const;
+
+  private:
+    struct Entry
+    {
+        uint64_t keyOffset;
+        uint64_t valueOffset;
+        uint32_t keyLength;
+        uint32_t valueLength;
+    };
+
+    std::string mArena;
+    std::vector<Entry> mEntries;
+};
+
+} // namespace ConfigurationBenchmark
+} // namespace AliceO2
+
+#endif // ALICEO2_CONFIGURATIONBENCHMARK_PARAMETERSET_H
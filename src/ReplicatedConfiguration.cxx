@@ -0,0 +1,252 @@
+/// \file ReplicatedConfiguration.cxx
+/// \brief Implementation of the ReplicatedConfiguration class.
+
+#include "ReplicatedConfiguration.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <stdexcept>
+#include "Clock.h"
+
+namespace AliceO2
+{
+namespace ConfigurationBenchmark
+{
+namespace
+{
+constexpr uint64_t HEDGE_REFRESH = 64; ///< Gets between recomputations of the hedge delay
+constexpr uint64_t HEDGE_MIN_SAMPLES = 20; ///< Observed latencies needed before hedging
+constexpr double AVERAGE_WEIGHT = 0.1; ///< Weight of a new latency in the moving averages
+} // Anonymous namespace
+
+template <typename T>
+struct ReplicatedConfiguration::Call
+{
+    std::mutex mutex;
+    std::condition_variable condition;
+    boost::optional<T> result; ///< First successful result
+    std::exception_ptr error; ///< Of the last failed request
+    int pending = 0; ///< Requests sent but not finished
+};
+
+ReplicatedConfiguration::ReplicatedConfiguration(
+    std::vector<std::unique_ptr<Configuration::ConfigurationInterface>> replicas, Policy policy, size_t primary,
+    double hedgePercentile)
+    : mPolicy(policy), mPrimary(primary), mHedgePercentile(hedgePercentile), mHedgeDelay(0), mUntilHedgeRefresh(0),
+      mGenerator(std::random_device()()), mAverageLatency(replicas.size(), 0.0)
+{
+  if (replicas.empty() || primary >= replicas.size()) {
+    throw std::runtime_error("Replicated configuration needs replicas and a valid primary");
+  }
+  for (auto& replica : replicas) {
+    mWorkers.push_back(std::make_unique<ServerWorker>(std::move(replica)));
+  }
+}
+
+void ReplicatedConfiguration::putString(const std::string& path, const std::string& value)
+{
+  call<bool>([path, value](Configuration::ConfigurationInterface& configuration) {
+    configuration.putString(path, value);
+    return true;
+  }, false);
+}
+
+auto ReplicatedConfiguration::getString(const std::string& path) -> boost::optional<std::string>
+{
+  return call<boost::optional<std::string>>([path](Configuration::ConfigurationInterface& configuration) {
+    return configuration.getString(path);
+  }, true);
+}
+
+void ReplicatedConfiguration::setPrefix(const std::string& path)
+{
+  for (auto& worker : mWorkers) {
+    worker->submit([path](Configuration::ConfigurationInterface& configuration) {
+      configuration.setPrefix(path);
+    });
+  }
+}
+
+void ReplicatedConfiguration::resetPrefix()
+{
+  for (auto& worker : mWorkers) {
+    worker->submit([](Configuration::ConfigurationInterface& configuration) {
+      configuration.resetPrefix();
+    });
+  }
+}
+
+auto ReplicatedConfiguration::getRecursive(const std::string& path) -> Configuration::Tree::Node
+{
+  return call<Configuration::Tree::Node>([path](Configuration::ConfigurationInterface& configuration) {
+    return configuration.getRecursive(path);
+  }, true);
+}
+
+auto ReplicatedConfiguration::statistics() const -> Statistics
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  return mStatistics;
+}
+
+void ReplicatedConfiguration::resetStatistics()
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  mStatistics = Statistics();
+}
+
+template <typename T>
+T ReplicatedConfiguration::call(const Operation<T>& operation, bool usePolicy)
+{
+  auto call = std::make_shared<Call<T>>();
+  auto replicas = mWorkers.size();
+  auto spread = usePolicy && replicas > 1;
+
+  if (!spread || mPolicy == Policy::Hedged) {
+    send(call, mPrimary, operation, usePolicy);
+  } else if (mPolicy == Policy::TwoChoices) {
+    std::uniform_int_distribution<size_t> first(0, replicas - 1);
+    std::uniform_int_distribution<size_t> offset(1, replicas - 1);
+    auto a = first(mGenerator);
+    auto b = (a + offset(mGenerator)) % replicas;
+    send(call, best({a, b}), operation, usePolicy);
+  } else {
+    for (size_t i = 0; i < replicas; ++i) {
+      send(call, i, operation, usePolicy);
+    }
+  }
+
+  if (usePolicy) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mStatistics.requests++;
+  }
+
+  auto finished = [&]{ return call->result || call->pending == 0; };
+  if (spread && mPolicy == Policy::Hedged) {
+    // Hedges once the delay passed, or right away if the primary failed
+    auto delay = hedgeDelay();
+    bool hedge;
+    {
+      std::unique_lock<std::mutex> lock(call->mutex);
+      if (delay > 0) {
+        call->condition.wait_for(lock, std::chrono::nanoseconds(delay), finished);
+      } else {
+        call->condition.wait(lock, finished);
+      }
+      hedge = !call->result;
+    }
+    if (hedge) {
+      std::vector<size_t> others;
+      for (size_t i = 0; i < replicas; ++i) {
+        if (i != mPrimary) {
+          others.push_back(i);
+        }
+      }
+      send(call, best(others), operation, usePolicy);
+    }
+  }
+
+  std::unique_lock<std::mutex> lock(call->mutex);
+  call->condition.wait(lock, finished);
+  if (!call->result) {
+    std::rethrow_exception(call->error);
+  }
+  return std::move(*call->result);
+}
+
+template <typename T>
+void ReplicatedConfiguration::send(const std::shared_ptr<Call<T>>& call, size_t replica,
+    const Operation<T>& operation, bool counted)
+{
+  {
+    std::lock_guard<std::mutex> lock(call->mutex);
+    call->pending++;
+  }
+
+  auto task = [this, call, replica, operation, counted](Configuration::ConfigurationInterface& configuration) {
+    // Skips a request whose get was already answered by another replica, so slow replicas do not build up a queue
+    // of abandoned requests
+    bool abandoned;
+    {
+      std::lock_guard<std::mutex> lock(call->mutex);
+      abandoned = bool(call->result);
+      if (abandoned) {
+        call->pending--;
+      }
+    }
+    if (abandoned) {
+      call->condition.notify_all();
+      return;
+    }
+    if (counted) {
+      std::lock_guard<std::mutex> lock(mMutex);
+      mStatistics.sent++;
+    }
+
+    boost::optional<T> result;
+    std::exception_ptr error;
+    auto started = Clock::now();
+    try {
+      result = operation(configuration);
+    }
+    catch (...) {
+      error = std::current_exception();
+    }
+    if (result) {
+      record(replica, Clock::since(started), counted);
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(call->mutex);
+      call->pending--;
+      if (result && !call->result) {
+        call->result = std::move(result);
+      }
+      if (error) {
+        call->error = error;
+      }
+    }
+    call->condition.notify_all();
+  };
+  mWorkers[replica]->submit(task);
+}
+
+void ReplicatedConfiguration::record(size_t replica, uint64_t latency, bool counted)
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  mLatency.record(latency);
+  auto& average = mAverageLatency[replica];
+  average = average == 0.0 ? double(latency) : average + AVERAGE_WEIGHT * (double(latency) - average);
+  if (counted && replica == mPrimary && mPolicy != Policy::TwoChoices) {
+    mStatistics.primaryLatency.record(latency);
+  }
+}
+
+size_t ReplicatedConfiguration::best(const std::vector<size_t>& candidates) const
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  auto score = [&](size_t i) {
+    return mAverageLatency[i] * double(mWorkers[i]->outstanding() + 1);
+  };
+  return *std::min_element(candidates.begin(), candidates.end(), [&](size_t a, size_t b) {
+    return score(a) < score(b);
+  });
+}
+
+uint64_t ReplicatedConfiguration::hedgeDelay()
+{
+  if (mUntilHedgeRefresh == 0) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (mLatency.count() < HEDGE_MIN_SAMPLES) {
+      return 0;
+    }
+    mHedgeDelay = mLatency.percentile(mHedgePercentile);
+    mUntilHedgeRefresh = HEDGE_REFRESH;
+  }
+  mUntilHedgeRefresh--;
+  return mHedgeDelay;
+}
+
+} // namespace ConfigurationBenchmark
+} // namespace AliceO2
@@ -0,0 +1,114 @@
+/// \file ReplicatedConfiguration.h
+/// \brief Definition of the ReplicatedConfiguration class, which spreads requests over replicas of a server.
+
+#ifndef ALICEO2_CONFIGURATIONBENCHMARK_REPLICATEDCONFIGURATION_H
+#define ALICEO2_CONFIGURATIONBENCHMARK_REPLICATEDCONFIGURATION_H
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <vector>
+#include <boost/optional.hpp>
+#include "Configuration/ConfigurationInterface.h"
+#include "Histogram.h"
+#include "ServerWorker.h"
+
+namespace AliceO2
+{
+namespace ConfigurationBenchmark
+{
+
+/// ConfigurationInterface over replicas of the same configuration, which picks the replicas of every get by a policy
+/// to cut the tail latency caused by slow replicas. Every replica has a ServerWorker, so requests to several replicas
+/// can be in flight at once. A get returns the first successful response. The other requests still run to completion
+/// if their replica already started them, which is the extra load of the policy, and are skipped otherwise.
+///
+/// Puts go to the primary replica only. Not thread-safe, like the configurations it wraps.
+class ReplicatedConfiguration : public Configuration::ConfigurationInterface
+{
+  public:
+    enum class Policy
+    {
+      TwoChoices, ///< Sends to the better of two random replicas, by observed latency and outstanding requests
+      Hedged, ///< Sends to the primary, and also to the best other replica if there is no response after a delay
+      FanOut ///< Sends to all replicas
+    };
+
+    struct Statistics
+    {
+        uint64_t requests = 0; ///< Gets made
+        uint64_t sent = 0; ///< Gets started by replicas, not counting those skipped because they were answered
+        /// Latencies of the gets on the primary replica, from when it started them, which are the ones it would have
+        /// had without the policy. Excludes waiting behind requests of earlier gets, which only exist because of the
+        /// policy. Only recorded by the policies that always send to the primary.
+        Histogram primaryLatency;
+    };
+
+    /// \param primary Index of the replica used without a policy
+    /// \param hedgePercentile Percentile [0, 100] of the observed latencies of the replicas after which a get is hedged
+    ReplicatedConfiguration(std::vector<std::unique_ptr<Configuration::ConfigurationInterface>> replicas,
+        Policy policy, size_t primary, double hedgePercentile);
+
+    virtual ~ReplicatedConfiguration()
+    {
+    }
+
+    virtual void putString(const std::string& path, const std::string& value);
+    virtual auto getString(const std::string& path) -> boost::optional<std::string>;
+    virtual void setPrefix(const std::string& path);
+    virtual void resetPrefix();
+    virtual auto getRecursive(const std::string& path = "") -> Configuration::Tree::Node;
+
+    Statistics statistics() const;
+
+    /// Resets the statistics, but not the observed latencies the policies are based on
+    void resetStatistics();
+
+  private:
+    template <typename T>
+    struct Call;
+
+    template <typename T>
+    using Operation = std::function<T(Configuration::ConfigurationInterface&)>;
+
+    /// Sends the operation to the replicas picked by the policy, or to the primary only
+    /// \return The first successful result
+    template <typename T>
+    T call(const Operation<T>& operation, bool usePolicy);
+
+    /// \param counted If the request is a get that counts for the statistics
+    template <typename T>
+    void send(const std::shared_ptr<Call<T>>& call, size_t replica, const Operation<T>& operation, bool counted);
+
+    /// Records a successful request, for the policies and the statistics
+    void record(size_t replica, uint64_t latency, bool counted);
+
+    /// \return Index of the replica with the lowest observed latency times outstanding requests, among the candidates
+    size_t best(const std::vector<size_t>& candidates) const;
+
+    /// \return Delay before hedging a get in nanoseconds, or 0 as long as too few latencies were observed
+    uint64_t hedgeDelay();
+
+    Policy mPolicy;
+    size_t mPrimary;
+    double mHedgePercentile;
+    uint64_t mHedgeDelay; ///< Cached, recomputed every HEDGE_REFRESH gets
+    uint64_t mUntilHedgeRefresh;
+    std::mt19937_64 mGenerator;
+
+    /// Guards the members below, which the workers update
+    mutable std::mutex mMutex;
+    Statistics mStatistics;
+    Histogram mLatency; ///< Latencies of all successful requests to the replicas
+    std::vector<double> mAverageLatency; ///< Moving average per replica, in nanoseconds
+
+    std::vector<std::unique_ptr<ServerWorker>> mWorkers; ///< Last, so the workers stop before the rest is destroyed
+};
+
+} // namespace ConfigurationBenchmark
+} // namespace AliceO2
+
+#endif // ALICEO2_CONFIGURATIONBENCHMARK_REPLICATEDCONFIGURATION_H
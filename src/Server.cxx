@@ -0,0 +1,78 @@
+/// \file Server.cxx
+/// \brief Stand-in configuration server, serving the key-value HTTP API subset of Consul and etcd from memory.
+///
+/// Makes it possible to load-test the whole client stack, including HTTP and sockets, without an external service.
+
+#include <boost/program_options.hpp>
+#include <iostream>
+#include <string>
+#include <thread>
+#include "KeyValueServer.h"
+#include "MockStore.h"
+
+namespace {
+
+using namespace AliceO2::ConfigurationBenchmark;
+namespace po = boost::program_options;
+
+struct Options
+{
+    std::string address;
+    int port;
+    int threads;
+    int shards;
+    bool help;
+};
+
+auto getOptions(int argc, char** argv) -> Options
+{
+  Options options;
+
+  auto optionsDescription = po::options_description("Options");
+  optionsDescription.add_options()
+      ("help",
+          po::bool_switch(&options.help)->default_value(false),
+          "Print help")
+      ("address",
+          po::value<std::string>(&options.address)->default_value("0.0.0.0"),
+          "IPv4 address to listen on")
+      ("port",
+          po::value<int>(&options.port)->default_value(8500),
+          "Port to listen on. Clients use it as a Consul or etcd server, e.g. 'consul://localhost:8500/conf-bench'")
+      ("threads",
+          po::value<int>(&options.threads)->default_value(std::thread::hardware_concurrency()),
+          "Number of server threads, each with their own listening socket and epoll instance")
+      ("shards",
+          po::value<int>(&options.shards)->default_value(64),
+          "Number of shards of the in-memory store");
+
+  auto map = po::variables_map();
+  po::store(po::parse_command_line(argc, argv, optionsDescription), map);
+  po::notify(map);
+
+  if (options.help) {
+    std::cout << optionsDescription << '\n';
+  }
+
+  return options;
+}
+} // Anonymous namespace
+
+int main(int argc, char** argv)
+{
+  try {
+    const Options options = getOptions(argc, argv);
+    if (options.help) {
+      return 0;
+    }
+
+    auto store = std::make_shared<MockStore>(options.shards, 0);
+    KeyValueServer server(store, options.address, options.port, options.threads);
+    std::cout << "Serving on " << options.address << ':' << options.port << " with " << options.threads
+        << " threads\n";
+    server.run();
+  } catch (const std::exception& e) {
+    std::cerr << "FATAL: " << e.what() << '\n';
+    return 1;
+  }
+}
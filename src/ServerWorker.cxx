@@ -0,0 +1,65 @@
+/// \file ServerWorker.cxx
+/// \brief Implementation of the ServerWorker class.
+
+#include "ServerWorker.h"
+
+namespace AliceO2
+{
+namespace ConfigurationBenchmark
+{
+
+ServerWorker::ServerWorker(std::unique_ptr<Configuration::ConfigurationInterface> configuration)
+    : mConfiguration(std::move(configuration)), mOutstanding(0), mStop(false)
+{
+  mThread = std::thread(&ServerWorker::run, this);
+}
+
+ServerWorker::~ServerWorker()
+{
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mStop = true;
+  }
+  mCondition.notify_one();
+  mThread.join();
+}
+
+void ServerWorker::submit(Task task)
+{
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mTasks.push_back(std::move(task));
+    mOutstanding++;
+  }
+  mCondition.notify_one();
+}
+
+size_t ServerWorker::outstanding() const
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  return mOutstanding;
+}
+
+void ServerWorker::run()
+{
+  for (;;) {
+    Task task;
+    {
+      std::unique_lock<std::mutex> lock(mMutex);
+      mCondition.wait(lock, [&]{ return mStop || !mTasks.empty(); });
+      if (mStop) {
+        return;
+      }
+      task = std::move(mTasks.front());
+      mTasks.pop_front();
+    }
+
+    task(*mConfiguration);
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    mOutstanding--;
+  }
+}
+
+} // namespace ConfigurationBenchmark
+} // namespace AliceO2
@@ -0,0 +1,57 @@
+/// \file ServerWorker.h
+/// \brief Definition of the ServerWorker class, a configuration used by a thread of its own.
+
+#ifndef ALICEO2_CONFIGURATIONBENCHMARK_SERVERWORKER_H
+#define ALICEO2_CONFIGURATIONBENCHMARK_SERVERWORKER_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include "Configuration/ConfigurationInterface.h"
+
+namespace AliceO2
+{
+namespace ConfigurationBenchmark
+{
+
+/// Does requests to one server on a thread of its own, so requests to several servers can be in flight at once.
+/// The ConfigurationInterface is not thread-safe, so it is only ever used by that thread, and the requests are done
+/// one at a time in the order they were submitted.
+class ServerWorker
+{
+  public:
+    /// Does a request with the configuration. Must not throw, it runs on the thread of the worker.
+    using Task = std::function<void(Configuration::ConfigurationInterface&)>;
+
+    explicit ServerWorker(std::unique_ptr<Configuration::ConfigurationInterface> configuration);
+
+    /// Discards the tasks that did not start yet, and waits for the running one
+    ~ServerWorker();
+
+    ServerWorker(const ServerWorker&) = delete;
+    ServerWorker& operator=(const ServerWorker&) = delete;
+
+    void submit(Task task);
+
+    /// Number of tasks submitted but not finished yet, for comparing the load of servers
+    size_t outstanding() const;
+
+  private:
+    void run();
+
+    std::unique_ptr<Configuration::ConfigurationInterface> mConfiguration;
+    mutable std::mutex mMutex;
+    std::condition_variable mCondition;
+    std::deque<Task> mTasks;
+    size_t mOutstanding;
+    bool mStop;
+    std::thread mThread;
+};
+
+} // namespace ConfigurationBenchmark
+} // namespace AliceO2
+
+#endif // ALICEO2_CONFIGURATIONBENCHMARK_SERVERWORKER_H
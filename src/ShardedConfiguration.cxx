@@ -0,0 +1,196 @@
+/// \file ShardedConfiguration.cxx
+/// \brief Implementation of the ShardRing and ShardedConfiguration classes.
+
+#include "ShardedConfiguration.h"
+#include <algorithm>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+#include "Clock.h"
+#include "Hash.h"
+
+namespace AliceO2
+{
+namespace ConfigurationBenchmark
+{
+namespace
+{
+using Configuration::Tree::Branch;
+using Configuration::Tree::Node;
+
+/// Merges a tree returned by another server into one. Servers hold different keys, so only directories overlap.
+void merge(Node& into, Node& from)
+{
+  auto intoBranch = boost::get<Branch>(&into);
+  auto fromBranch = boost::get<Branch>(&from);
+  if (intoBranch && fromBranch) {
+    for (auto& child : *fromBranch) {
+      auto found = intoBranch->find(child.first);
+      if (found == intoBranch->end()) {
+        intoBranch->emplace(child.first, std::move(child.second));
+      } else {
+        merge(found->second, child.second);
+      }
+    }
+  } else if (intoBranch && intoBranch->empty()) {
+    // A server without keys under the path returns an empty directory, the owner of a single key returns its value
+    into = std::move(from);
+  }
+}
+} // Anonymous namespace
+
+constexpr int ShardRing::VIRTUAL_NODES;
+
+ShardRing::ShardRing(const std::vector<std::string>& servers)
+    : mServers(servers.size())
+{
+  if (servers.empty()) {
+    throw std::runtime_error("Shard ring needs servers");
+  }
+  for (size_t server = 0; server < servers.size(); ++server) {
+    for (int i = 0; i < VIRTUAL_NODES; ++i) {
+      mPoints.push_back(Point{hash64(servers[server] + '#' + std::to_string(i)), server});
+    }
+  }
+  std::sort(mPoints.begin(), mPoints.end(), [](const Point& a, const Point& b) {
+    return a.hash != b.hash ? a.hash < b.hash : a.server < b.server;
+  });
+}
+
+size_t ShardRing::shard(boost::string_ref key) const
+{
+  auto hash = hash64(key);
+  auto point = std::lower_bound(mPoints.begin(), mPoints.end(), hash, [](const Point& point, uint64_t hash) {
+    return point.hash < hash;
+  });
+  return point == mPoints.end() ? mPoints.front().server : point->server;
+}
+
+ShardedConfiguration::ShardedConfiguration(const std::vector<std::string>& uris,
+    const std::function<std::unique_ptr<Configuration::ConfigurationInterface>(const std::string&)>&
+        makeConfiguration)
+    : mRing(uris)
+{
+  for (const auto& uri : uris) {
+    mWorkers.push_back(std::make_unique<ServerWorker>(makeConfiguration(uri)));
+  }
+}
+
+void ShardedConfiguration::putString(const std::string& path, const std::string& value)
+{
+  run({{mRing.shard(path), [&](Configuration::ConfigurationInterface& configuration) {
+    configuration.putString(path, value);
+  }}});
+}
+
+auto ShardedConfiguration::getString(const std::string& path) -> boost::optional<std::string>
+{
+  boost::optional<std::string> value;
+  run({{mRing.shard(path), [&](Configuration::ConfigurationInterface& configuration) {
+    value = configuration.getString(path);
+  }}});
+  return value;
+}
+
+void ShardedConfiguration::setPrefix(const std::string& path)
+{
+  std::vector<std::pair<size_t, Task>> tasks;
+  for (size_t shard = 0; shard < mWorkers.size(); ++shard) {
+    tasks.emplace_back(shard, [&](Configuration::ConfigurationInterface& configuration) {
+      configuration.setPrefix(path);
+    });
+  }
+  run(std::move(tasks));
+}
+
+void ShardedConfiguration::resetPrefix()
+{
+  std::vector<std::pair<size_t, Task>> tasks;
+  for (size_t shard = 0; shard < mWorkers.size(); ++shard) {
+    tasks.emplace_back(shard, [](Configuration::ConfigurationInterface& configuration) {
+      configuration.resetPrefix();
+    });
+  }
+  run(std::move(tasks));
+}
+
+auto ShardedConfiguration::getRecursive(const std::string& path) -> Configuration::Tree::Node
+{
+  std::vector<Node> nodes(mWorkers.size());
+  std::vector<std::pair<size_t, Task>> tasks;
+  for (size_t shard = 0; shard < mWorkers.size(); ++shard) {
+    tasks.emplace_back(shard, [&, shard](Configuration::ConfigurationInterface& configuration) {
+      nodes[shard] = configuration.getRecursive(path);
+    });
+  }
+  run(std::move(tasks));
+
+  for (size_t shard = 1; shard < nodes.size(); ++shard) {
+    merge(nodes[0], nodes[shard]);
+  }
+  return std::move(nodes[0]);
+}
+
+auto ShardedConfiguration::getStrings(const std::vector<std::string>& keys) -> std::vector<Response>
+{
+  std::vector<Response> responses(keys.size());
+  std::vector<std::vector<size_t>> byShard(mWorkers.size());
+  for (size_t i = 0; i < keys.size(); ++i) {
+    byShard[mRing.shard(keys[i])].push_back(i);
+  }
+
+  // Every server writes the responses of its own keys
+  std::vector<std::pair<size_t, Task>> tasks;
+  for (size_t shard = 0; shard < mWorkers.size(); ++shard) {
+    if (!byShard[shard].empty()) {
+      tasks.emplace_back(shard, [&, shard](Configuration::ConfigurationInterface& configuration) {
+        for (auto i : byShard[shard]) {
+          auto start = Clock::now();
+          responses[i].value = configuration.getString(keys[i]);
+          responses[i].latency = Clock::since(start);
+        }
+      });
+    }
+  }
+  run(std::move(tasks));
+  return responses;
+}
+
+void ShardedConfiguration::run(std::vector<std::pair<size_t, Task>> tasks)
+{
+  std::mutex mutex;
+  std::condition_variable done;
+  size_t remaining = tasks.size();
+  std::exception_ptr error;
+
+  for (auto& task : tasks) {
+    auto function = std::move(task.second);
+    mWorkers[task.first]->submit([&, function](Configuration::ConfigurationInterface& configuration) {
+      std::exception_ptr taskError;
+      try {
+        function(configuration);
+      }
+      catch (...) {
+        taskError = std::current_exception();
+      }
+      // Notifies under the lock, so the waiting caller cannot return and destroy the condition before
+      std::lock_guard<std::mutex> lock(mutex);
+      if (taskError && !error) {
+        error = taskError;
+      }
+      if (--remaining == 0) {
+        done.notify_all();
+      }
+    });
+  }
+
+  std::unique_lock<std::mutex> lock(mutex);
+  done.wait(lock, [&]{ return remaining == 0; });
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+} // namespace ConfigurationBenchmark
+} // namespace AliceO2
@@ -0,0 +1,100 @@
+/// \file ShardedConfiguration.h
+/// \brief Definition of the ShardRing and ShardedConfiguration classes, which partition keys over servers.
+
+#ifndef ALICEO2_CONFIGURATIONBENCHMARK_SHARDEDCONFIGURATION_H
+#define ALICEO2_CONFIGURATIONBENCHMARK_SHARDEDCONFIGURATION_H
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include <boost/optional.hpp>
+#include <boost/utility/string_ref.hpp>
+#include "Configuration/ConfigurationInterface.h"
+#include "ServerWorker.h"
+
+namespace AliceO2
+{
+namespace ConfigurationBenchmark
+{
+
+/// Consistent-hash ring that assigns every key to one of the servers. Every server has VIRTUAL_NODES points on the
+/// ring, hashed from its URI, and a key belongs to the server of the first point at or after the hash of the key.
+/// Adding or removing a server only moves the keys of its own points, and all clients with the same server URIs
+/// assign keys the same way without coordinating.
+class ShardRing
+{
+  public:
+    static constexpr int VIRTUAL_NODES = 160;
+
+    explicit ShardRing(const std::vector<std::string>& servers);
+
+    /// \return Index of the server that owns the key
+    size_t shard(boost::string_ref key) const;
+
+    /// Number of servers
+    size_t size() const
+    {
+      return mServers;
+    }
+
+  private:
+    struct Point
+    {
+        uint64_t hash;
+        size_t server;
+    };
+
+    std::vector<Point> mPoints; ///< Sorted by hash
+    size_t mServers;
+};
+
+/// ConfigurationInterface over servers that each hold the keys a ShardRing assigns to them. Every server has a
+/// ServerWorker, so the requests to different servers run in parallel.
+///
+/// Gets and puts of single keys go to the owning server. Recursive gets go to all servers, and their trees are merged.
+/// Not thread-safe, like the configurations it wraps.
+class ShardedConfiguration : public Configuration::ConfigurationInterface
+{
+  public:
+    struct Response
+    {
+        boost::optional<std::string> value;
+        uint64_t latency; ///< Of the request on its server, in nanoseconds
+    };
+
+    /// \param makeConfiguration Creates the configuration of a server from its URI
+    ShardedConfiguration(const std::vector<std::string>& uris,
+        const std::function<std::unique_ptr<Configuration::ConfigurationInterface>(const std::string&)>&
+            makeConfiguration);
+
+    virtual ~ShardedConfiguration()
+    {
+    }
+
+    virtual void putString(const std::string& path, const std::string& value);
+    virtual auto getString(const std::string& path) -> boost::optional<std::string>;
+    virtual void setPrefix(const std::string& path);
+    virtual void resetPrefix();
+    virtual auto getRecursive(const std::string& path = "") -> Configuration::Tree::Node;
+
+    /// Gets the keys, one request per key. The servers do their requests in parallel, and each does them in order.
+    /// \return Responses in the order of the keys
+    std::vector<Response> getStrings(const std::vector<std::string>& keys);
+
+  private:
+    using Task = std::function<void(Configuration::ConfigurationInterface&)>;
+
+    /// Runs the tasks on the workers of their servers and waits for all of them. Rethrows the first error, if any.
+    void run(std::vector<std::pair<size_t, Task>> tasks);
+
+    ShardRing mRing;
+    std::vector<std::unique_ptr<ServerWorker>> mWorkers;
+};
+
+} // namespace ConfigurationBenchmark
+} // namespace AliceO2
+
+#endif // ALICEO2_CONFIGURATIONBENCHMARK_SHARDEDCONFIGURATION_H
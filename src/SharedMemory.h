@@ -0,0 +1,50 @@
+/// \file SharedMemory.h
+/// \brief Definition of the SharedMemory class.
+
+#ifndef ALICEO2_CONFIGURATIONBENCHMARK_SHAREDMEMORY_H
+#define ALICEO2_CONFIGURATIONBENCHMARK_SHAREDMEMORY_H
+
+#include <sys/mman.h>
+#include <cstddef>
+#include <stdexcept>
+
+namespace AliceO2
+{
+namespace ConfigurationBenchmark
+{
+
+/// Zero-initialized anonymous memory that stays shared with processes forked after its creation
+class SharedMemory
+{
+  public:
+    explicit SharedMemory(size_t size)
+        : mSize(size)
+    {
+      mMemory = mmap(nullptr, mSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+      if (mMemory == MAP_FAILED) {
+        throw std::runtime_error("Failed to map shared memory");
+      }
+    }
+
+    ~SharedMemory()
+    {
+      munmap(mMemory, mSize);
+    }
+
+    SharedMemory(const SharedMemory&) = delete;
+    SharedMemory& operator=(const SharedMemory&) = delete;
+
+    void* get() const
+    {
+      return mMemory;
+    }
+
+  private:
+    size_t mSize;
+    void* mMemory;
+};
+
+} // namespace ConfigurationBenchmark
+} // namespace AliceO2
+
+#endif // ALICEO2_CONFIGURATIONBENCHMARK_SHAREDMEMORY_H
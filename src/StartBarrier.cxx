@@ -0,0 +1,86 @@
+/// \file StartBarrier.cxx
+/// \brief Implementation of the StartBarrier class.
+
+#include "StartBarrier.h"
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <climits>
+#include <ctime>
+#include <stdexcept>
+#include "Clock.h"
+
+namespace AliceO2
+{
+namespace ConfigurationBenchmark
+{
+
+constexpr uint64_t StartBarrier::RELEASE_MARGIN;
+constexpr uint64_t StartBarrier::ARRIVAL_TIMEOUT;
+
+namespace
+{
+static_assert(sizeof(std::atomic<int>) == sizeof(int), "Futex word must be a plain int");
+
+/// Futex operations without FUTEX_PRIVATE_FLAG, so they also work between processes
+void futexWait(std::atomic<int>& word, int expected, const timespec* timeout)
+{
+  syscall(SYS_futex, reinterpret_cast<int*>(&word), FUTEX_WAIT, expected, timeout, nullptr, 0);
+}
+
+void futexWakeAll(std::atomic<int>& word)
+{
+  syscall(SYS_futex, reinterpret_cast<int*>(&word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+}
+} // Anonymous namespace
+
+StartBarrier::StartBarrier(int parties, uint64_t wallDeadline)
+    : mParties(parties), mWallDeadline(wallDeadline), mArrived(0), mReady(0), mReleaseTime(0)
+{
+}
+
+uint64_t StartBarrier::arriveAndWait()
+{
+  if (mArrived.fetch_add(1) + 1 == mParties) {
+    // Last to arrive: determine the release time for everyone
+    auto now = Clock::now();
+    auto wallNow = Clock::wallNow();
+    auto release = now + RELEASE_MARGIN;
+    if (mWallDeadline > wallNow + RELEASE_MARGIN) {
+      release = now + (mWallDeadline - wallNow);
+    }
+    mReleaseTime.store(release);
+    mReady.store(1);
+    futexWakeAll(mReady);
+  } else {
+    // Nothing time-critical happens until all parties arrived, so we can block in the kernel
+    auto timeout = Clock::now() + ARRIVAL_TIMEOUT;
+    const timespec interval {1, 0};
+    while (mReady.load() == 0) {
+      futexWait(mReady, 0, &interval);
+      if (mReady.load() == 0 && Clock::now() > timeout) {
+        throw std::runtime_error("Timed out waiting for other clients at start barrier");
+      }
+    }
+  }
+
+  auto release = mReleaseTime.load();
+  Clock::sleepUntil(release);
+  auto now = Clock::now();
+  return now > release ? now - release : 0;
+}
+
+uint64_t StartBarrier::nextInterval()
+{
+  // Calculated on the epoch instead of a broken-down time, so there are no special cases for minute or hour rollover
+  constexpr uint64_t second = 1000000000;
+  constexpr uint64_t minute = 60 * second;
+  constexpr uint64_t offset = 10 * second;
+
+  auto now = Clock::wallNow();
+  auto next = now - (now % minute) + offset;
+  return next > now ? next : next + minute;
+}
+
+} // namespace ConfigurationBenchmark
+} // namespace AliceO2
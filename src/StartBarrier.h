@@ -0,0 +1,55 @@
+/// \file StartBarrier.h
+/// \brief Definition of the StartBarrier class.
+
+#ifndef ALICEO2_CONFIGURATIONBENCHMARK_STARTBARRIER_H
+#define ALICEO2_CONFIGURATIONBENCHMARK_STARTBARRIER_H
+
+#include <atomic>
+#include <cstdint>
+
+namespace AliceO2
+{
+namespace ConfigurationBenchmark
+{
+
+/// Releases all clients of a node at the same moment, to simulate the "start command".
+///
+/// The barrier waits until all parties have arrived, and then until an optional wall-clock deadline, which allows
+/// clients on different nodes to start together. The release time is converted to the monotonic clock once, and every
+/// party sleeps and then spins until that time on its own. This avoids the wake-up latency of a futex broadcast, which
+/// grows with the number of waiters.
+///
+/// Contains no pointers, so it can be placed in SharedMemory and used by forked processes as well as by threads.
+class StartBarrier
+{
+  public:
+    /// \param parties Number of parties that must arrive before release
+    /// \param wallDeadline Wall-clock release time in nanoseconds since the Unix epoch, 0 to release as soon as all
+    ///   parties arrived
+    StartBarrier(int parties, uint64_t wallDeadline);
+
+    /// Blocks until release.
+    /// \return How late the caller was released in nanoseconds, relative to the release time
+    uint64_t arriveAndWait();
+
+    /// Wall-clock time in nanoseconds of the next moment that is 10 seconds past a whole minute
+    static uint64_t nextInterval();
+
+  private:
+    /// Extra margin before release when the deadline already passed, so all parties get to the spinning phase in time
+    static constexpr uint64_t RELEASE_MARGIN = 10000000;
+
+    /// How long to wait for all parties to arrive before giving up
+    static constexpr uint64_t ARRIVAL_TIMEOUT = 600000000000;
+
+    const int mParties;
+    const uint64_t mWallDeadline;
+    std::atomic<int> mArrived;
+    std::atomic<int> mReady; ///< Futex word, set to 1 when all parties arrived
+    std::atomic<uint64_t> mReleaseTime; ///< Monotonic release time, valid once mReady is set
+};
+
+} // namespace ConfigurationBenchmark
+} // namespace AliceO2
+
+#endif // ALICEO2_CONFIGURATIONBENCHMARK_STARTBARRIER_H
@@ -0,0 +1,179 @@
+/// \file TreeDigest.cxx
+/// \brief Implementation of the TreeDigest class.
+
+#include "TreeDigest.h"
+#include <stdexcept>
+#include "Hash.h"
+
+namespace AliceO2
+{
+namespace ConfigurationBenchmark
+{
+namespace
+{
+using Configuration::Tree::Branch;
+using Configuration::Tree::Leaf;
+using Configuration::Tree::Node;
+
+constexpr uint64_t LEAF_SEED = 0x6c656166; ///< Seed for the hashes of values, so they differ from those of names
+
+/// Value of a leaf node, converted into the buffer if it is not a string
+boost::string_ref leafValue(const Node& node, std::string& buffer)
+{
+  const auto& leaf = boost::get<Leaf>(node);
+  if (auto value = boost::get<std::string>(&leaf)) {
+    return *value;
+  }
+  buffer = Configuration::Tree::convert<std::string>(leaf);
+  return buffer;
+}
+
+/// Hash of a child of a directory
+uint64_t childHash(boost::string_ref name, uint64_t digest)
+{
+  return hash64(name, digest);
+}
+
+/// If the directory is the other one, or one of its ancestors
+bool contains(const std::string& directory, boost::string_ref other)
+{
+  return directory.empty() || other == directory
+      || (other.starts_with(directory) && other.size() > directory.size() && other[directory.size()] == '/');
+}
+} // Anonymous namespace
+
+TreeDigest::TreeDigest(ParameterGenerator& expected, const std::string& root)
+    : mRoot(root)
+{
+  // The sorted keys are walked like a depth-first traversal, with a stack of the directories of the current key.
+  // A directory is complete once a key outside of it comes along, since sorted keys never return to it.
+  struct Frame
+  {
+      std::string path;
+      uint64_t sum;
+      size_t begin;
+  };
+  std::vector<Frame> stack { Frame{"", 0, 0} };
+
+  auto close = [&](size_t end) {
+    auto frame = std::move(stack.back());
+    stack.pop_back();
+    mDirectories[frame.path] = Directory{frame.sum, frame.begin, end};
+    if (!stack.empty()) {
+      auto name = boost::string_ref(frame.path).substr(frame.path.rfind('/') + 1);
+      stack.back().sum += childHash(name, frame.sum);
+    }
+  };
+
+  for (size_t i = 0; i < expected.size(); ++i) {
+    auto parameter = expected.get(i);
+    if (!parameter.key.starts_with(mRoot) || parameter.key.size() <= mRoot.size()
+        || parameter.key[mRoot.size()] != '/') {
+      throw std::runtime_error("Parameter '" + parameter.key.to_string() + "' is not under '" + mRoot + "'");
+    }
+    auto relative = parameter.key.substr(mRoot.size());
+    auto slash = relative.rfind('/');
+    auto directory = relative.substr(0, slash);
+    auto name = relative.substr(slash + 1);
+
+    while (!contains(stack.back().path, directory)) {
+      close(i);
+    }
+    while (stack.back().path.size() < directory.size()) {
+      auto start = stack.back().path.size() + 1;
+      auto next = directory.substr(start).find('/');
+      auto length = next == boost::string_ref::npos ? directory.size() : start + next;
+      stack.push_back(Frame{directory.substr(0, length).to_string(), 0, i});
+    }
+    stack.back().sum += childHash(name, hash64(parameter.value, LEAF_SEED));
+  }
+
+  while (!stack.empty()) {
+    close(expected.size());
+  }
+}
+
+uint64_t TreeDigest::digest() const
+{
+  return mDirectories.at("").digest;
+}
+
+uint64_t TreeDigest::digest(const Node& node)
+{
+  DigestCache cache;
+  return digest(node, cache);
+}
+
+uint64_t TreeDigest::digest(const Node& node, DigestCache& cache)
+{
+  if (auto branch = boost::get<Branch>(&node)) {
+    uint64_t sum = 0;
+    for (const auto& child : *branch) {
+      sum += childHash(child.first, digest(child.second, cache));
+    }
+    cache[&node] = sum;
+    return sum;
+  }
+  std::string buffer;
+  return hash64(leafValue(node, buffer), LEAF_SEED);
+}
+
+std::vector<std::string> TreeDigest::compare(const Node& node, Verifier& verifier) const
+{
+  DigestCache cache;
+  std::vector<std::string> diverged;
+  if (digest(node, cache) == digest()) {
+    const auto& root = mDirectories.at("");
+    verifier.accept(root.begin, root.end);
+    return diverged;
+  }
+
+  std::string path;
+  compare(node, path, verifier, cache, diverged);
+  return diverged;
+}
+
+bool TreeDigest::compare(const Node& node, std::string& path, Verifier& verifier, DigestCache& cache,
+    std::vector<std::string>& diverged) const
+{
+  std::string key;
+  std::string buffer;
+  auto branch = boost::get<Branch>(&node);
+  if (!branch) {
+    // A value where a directory is expected
+    verifier.check(mRoot + path, leafValue(node, buffer));
+    diverged.push_back(mRoot + path);
+    return true;
+  }
+
+  auto expected = mDirectories.find(path);
+  if (expected != mDirectories.end() && cache.at(&node) == expected->second.digest) {
+    verifier.accept(expected->second.begin, expected->second.end);
+    return false;
+  }
+
+  bool divergedBelow = false;
+  auto length = path.size();
+  for (const auto& child : *branch) {
+    path.resize(length);
+    path += '/';
+    path += child.first;
+    if (boost::get<Branch>(&child.second)) {
+      divergedBelow |= compare(child.second, path, verifier, cache, diverged);
+    } else {
+      key.assign(mRoot);
+      key += path;
+      verifier.check(key, leafValue(child.second, buffer));
+    }
+  }
+  path.resize(length);
+
+  // Missing parameters and differing values directly in this directory
+  if (!divergedBelow) {
+    diverged.push_back(mRoot + path);
+  }
+  return true;
+}
+
+} // namespace ConfigurationBenchmark
+} // namespace AliceO2
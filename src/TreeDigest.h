@@ -0,0 +1,77 @@
+/// \file TreeDigest.h
+/// \brief Definition of the TreeDigest class, a Merkle digest of the expected parameters of a subtree.
+
+#ifndef ALICEO2_CONFIGURATIONBENCHMARK_TREEDIGEST_H
+#define ALICEO2_CONFIGURATIONBENCHMARK_TREEDIGEST_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Configuration/Tree.h"
+#include "ParameterGenerator.h"
+#include "Verifier.h"
+
+namespace AliceO2
+{
+namespace ConfigurationBenchmark
+{
+
+/// Merkle digests of every directory of the expected parameters under a root path. The digest of a leaf is the hash
+/// of its value, the digest of a directory the sum of the hashes of the names of its children seeded with their
+/// digests. The sum does not depend on the order of the children, so the digest of a returned tree can be computed
+/// from its Configuration::Tree::Node in any order.
+///
+/// Comparing a returned tree then only checks the parameters of the directories whose digests differ. Identical
+/// trees cost one hash per value and directory, without building or looking up anything per parameter.
+///
+/// Immutable once built, so it can be shared by threads and, copy-on-write, by forked processes.
+class TreeDigest
+{
+  public:
+    /// \param expected Expected parameters, sorted by key, as given by a StoredParameterGenerator. Those under a
+    ///   directory are then a contiguous range.
+    /// \param root Path of the subtree, all keys must start with it
+    TreeDigest(ParameterGenerator& expected, const std::string& root);
+
+    /// Digest of the whole subtree
+    uint64_t digest() const;
+
+    const std::string& root() const
+    {
+      return mRoot;
+    }
+
+    /// Compares the tree returned for the root path against the expected one, and checks the parameters of the
+    /// differing directories with the verifier. Parameters of matching directories are accepted without checking, so
+    /// finishing the verifier only reports the missing ones of differing directories.
+    /// \return Paths of the deepest differing directories, where the returned tree diverged
+    std::vector<std::string> compare(const Configuration::Tree::Node& node, Verifier& verifier) const;
+
+    /// Digest of a returned tree
+    static uint64_t digest(const Configuration::Tree::Node& node);
+
+  private:
+    struct Directory
+    {
+        uint64_t digest;
+        size_t begin; ///< Index of the first parameter in the directory or its subdirectories
+        size_t end; ///< Index past the last one
+    };
+
+    using DigestCache = std::unordered_map<const Configuration::Tree::Node*, uint64_t>;
+
+    static uint64_t digest(const Configuration::Tree::Node& node, DigestCache& cache);
+
+    /// \return True if a diverged directory was found in the node or below
+    bool compare(const Configuration::Tree::Node& node, std::string& path, Verifier& verifier, DigestCache& cache,
+        std::vector<std::string>& diverged) const;
+
+    std::string mRoot;
+    std::unordered_map<std::string, Directory> mDirectories; ///< By path relative to the root, "" for the root
+};
+
+} // namespace ConfigurationBenchmark
+} // namespace AliceO2
+
+#endif // ALICEO2_CONFIGURATIONBENCHMARK_TREEDIGEST_H
@@ -0,0 +1,231 @@
+/// \file ValueGenerator.cxx
+/// \brief Implementation of the ValueGenerator class.
+
+#include "ValueGenerator.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <boost/algorithm/string.hpp>
+#include <boost/lexical_cast.hpp>
+#include "Encoding.h"
+
+namespace AliceO2
+{
+namespace ConfigurationBenchmark
+{
+namespace
+{
+constexpr size_t DEFAULT_SIZE = 100;
+constexpr uint64_t SIZE_SEED = 0x517e;
+constexpr uint64_t CONTENT_SEED = 0xc0de;
+const char TEXT_PREFIX[] = "value";
+constexpr size_t TEXT_PREFIX_SIZE = sizeof(TEXT_PREFIX) - 1;
+const char RANDOM_CHARACTERS[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+const char JSON_HEAD[] = "{\"id\":";
+const char JSON_VALUES[] = ",\"values\":[";
+const char JSON_TAIL[] = "],\"note\":\"";
+const char JSON_END[] = "\"}";
+
+/// SplitMix64, cheap to seed for every value, unlike std::mt19937_64
+class SplitMix64
+{
+  public:
+    using result_type = uint64_t;
+
+    explicit SplitMix64(uint64_t seed)
+        : mState(seed)
+    {
+    }
+
+    static constexpr result_type min()
+    {
+      return 0;
+    }
+
+    static constexpr result_type max()
+    {
+      return std::numeric_limits<result_type>::max();
+    }
+
+    result_type operator()()
+    {
+      uint64_t z = (mState += 0x9e3779b97f4a7c15ull);
+      z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+      z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+      return z ^ (z >> 31);
+    }
+
+  private:
+    uint64_t mState;
+};
+
+size_t digitCount(uint64_t number)
+{
+  size_t count = 1;
+  while (number >= 10) {
+    number /= 10;
+    count++;
+  }
+  return count;
+}
+
+template <size_t N>
+void appendLiteral(const char (&literal)[N], std::string& buffer)
+{
+  buffer.append(literal, N - 1);
+}
+} // Anonymous namespace
+
+ValueGenerator::ValueGenerator()
+    : mSizeType(SizeType::Fixed), mContentType(ContentType::Text), mFirst(DEFAULT_SIZE), mSecond(0)
+{
+}
+
+ValueGenerator::ValueGenerator(const std::string& sizeSpecification, const std::string& contentSpecification)
+    : mFirst(0), mSecond(0)
+{
+  std::vector<std::string> parts;
+  boost::split(parts, sizeSpecification, boost::is_any_of(":"));
+  auto expectParameters = [&](size_t n) {
+    if (parts.size() != n + 1) {
+      throw std::runtime_error("Invalid value size '" + sizeSpecification + "'");
+    }
+    if (n > 0) {
+      mFirst = boost::lexical_cast<double>(parts[1]);
+      mSecond = n > 1 ? boost::lexical_cast<double>(parts[2]) : 0.0;
+      if (mFirst < 0 || mSecond < 0) {
+        throw std::runtime_error("Invalid value size '" + sizeSpecification + "'");
+      }
+    }
+  };
+
+  if (parts[0] == "fixed") {
+    mSizeType = SizeType::Fixed;
+    expectParameters(1);
+  } else if (parts[0] == "uniform") {
+    mSizeType = SizeType::Uniform;
+    expectParameters(2);
+    if (mSecond < mFirst) {
+      throw std::runtime_error("Invalid value size '" + sizeSpecification + "', maximum is below minimum");
+    }
+  } else if (parts[0] == "lognormal") {
+    mSizeType = SizeType::LogNormal;
+    expectParameters(2);
+  } else if (parts[0] == "file" && parts.size() >= 2) {
+    mSizeType = SizeType::File;
+    auto path = sizeSpecification.substr(sizeSpecification.find(':') + 1);
+    std::ifstream file(path);
+    if (!file) {
+      throw std::runtime_error("Failed to open value size file '" + path + "'");
+    }
+    size_t size;
+    while (file >> size) {
+      mSizes.push_back(size);
+    }
+    if (mSizes.empty()) {
+      throw std::runtime_error("No value sizes in file '" + path + "'");
+    }
+  } else {
+    throw std::runtime_error("Invalid value size '" + sizeSpecification + "'");
+  }
+
+  if (contentSpecification == "text") {
+    mContentType = ContentType::Text;
+  } else if (contentSpecification == "random") {
+    mContentType = ContentType::Random;
+  } else if (contentSpecification == "json") {
+    mContentType = ContentType::Json;
+  } else {
+    throw std::runtime_error("Invalid value content '" + contentSpecification + "'");
+  }
+}
+
+size_t ValueGenerator::size(int number) const
+{
+  SplitMix64 generator(SIZE_SEED ^ (uint64_t(number) * 0x9e3779b97f4a7c15ull));
+  switch (mSizeType) {
+    case SizeType::Fixed:
+      return size_t(mFirst);
+    case SizeType::Uniform:
+      return std::uniform_int_distribution<size_t>(size_t(mFirst), size_t(mSecond))(generator);
+    case SizeType::LogNormal:
+      return mFirst > 0 ? size_t(std::lognormal_distribution<double>(std::log(mFirst), mSecond)(generator)) : 0;
+    case SizeType::File:
+      return mSizes[std::uniform_int_distribution<size_t>(0, mSizes.size() - 1)(generator)];
+  }
+  return 0;
+}
+
+void ValueGenerator::append(int number, std::string& buffer) const
+{
+  auto valueSize = size(number);
+  auto end = buffer.size() + valueSize;
+  buffer.reserve(end);
+  SplitMix64 generator(CONTENT_SEED ^ (uint64_t(number) * 0x9e3779b97f4a7c15ull));
+
+  switch (mContentType) {
+    case ContentType::Text: {
+      auto digits = digitCount(uint64_t(number));
+      if (valueSize >= TEXT_PREFIX_SIZE + digits) {
+        appendLiteral(TEXT_PREFIX, buffer);
+        appendDecimal(uint64_t(number), valueSize - TEXT_PREFIX_SIZE, buffer);
+      } else {
+        // Keep the least significant digits
+        auto start = buffer.size();
+        appendDecimal(uint64_t(number), valueSize, buffer);
+        buffer.erase(start, buffer.size() - end);
+      }
+      break;
+    }
+    case ContentType::Random:
+      for (size_t i = 0; i < valueSize; i += 8) {
+        auto bits = generator();
+        for (size_t j = i; j < std::min(i + 8, valueSize); ++j, bits >>= 6) {
+          buffer += RANDOM_CHARACTERS[bits & 0x3f];
+        }
+      }
+      break;
+    case ContentType::Json: {
+      auto minimumSize = sizeof(JSON_HEAD) - 1 + digitCount(uint64_t(number)) + sizeof(JSON_VALUES) - 1
+          + sizeof(JSON_TAIL) - 1 + sizeof(JSON_END) - 1;
+      if (valueSize < minimumSize) {
+        // Too small for an object, a number without leading zeros is still valid JSON
+        for (size_t i = 0; i < valueSize; ++i) {
+          buffer += char((i == 0 ? '1' : '0') + generator() % (i == 0 ? 9 : 10));
+        }
+        break;
+      }
+
+      appendLiteral(JSON_HEAD, buffer);
+      appendDecimal(uint64_t(number), 0, buffer);
+      appendLiteral(JSON_VALUES, buffer);
+      auto tailSize = sizeof(JSON_TAIL) - 1 + sizeof(JSON_END) - 1;
+      bool first = true;
+      while (true) {
+        auto item = generator() % 1000000;
+        auto itemSize = digitCount(item) + (first ? 0 : 1);
+        if (buffer.size() + itemSize + tailSize > end) {
+          break;
+        }
+        if (!first) {
+          buffer += ',';
+        }
+        appendDecimal(item, 0, buffer);
+        first = false;
+      }
+      appendLiteral(JSON_TAIL, buffer);
+      auto padding = end - buffer.size() - (sizeof(JSON_END) - 1);
+      for (size_t i = 0; i < padding; ++i) {
+        buffer += char('a' + generator() % 26);
+      }
+      appendLiteral(JSON_END, buffer);
+      break;
+    }
+  }
+}
+
+} // namespace ConfigurationBenchmark
+} // namespace AliceO2
@@ -0,0 +1,62 @@
+/// \file ValueGenerator.h
+/// \brief Definition of the ValueGenerator class, which generates the parameter values.
+
+#ifndef ALICEO2_CONFIGURATIONBENCHMARK_VALUEGENERATOR_H
+#define ALICEO2_CONFIGURATIONBENCHMARK_VALUEGENERATOR_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace AliceO2
+{
+namespace ConfigurationBenchmark
+{
+
+/// Generates the value of a parameter from its number. Values only depend on the number and the specifications, so
+/// every process generates the same ones.
+///
+/// Size specifications, in bytes:
+///   "fixed:SIZE", "uniform:MIN:MAX", "lognormal:MEDIAN:SIGMA", or "file:PATH" to draw from the sizes in the file,
+///   one per line, e.g. taken from a dump of a real configuration
+///
+/// Content specifications:
+///   "text": "value" followed by the zero-padded number, highly compressible. Only the number if it does not fit.
+///   "random": random characters of the base64 alphabet, incompressible but safe for text-based backends
+///   "json": a JSON object with an array of numbers and a string, or a JSON number if the size is too small
+class ValueGenerator
+{
+  public:
+    /// Generates what the benchmark always used: "value" followed by the number zero-padded to 100 bytes
+    ValueGenerator();
+
+    ValueGenerator(const std::string& sizeSpecification, const std::string& contentSpecification);
+
+    /// Appends the value to the buffer, which keeps its capacity, so repeated use does not allocate
+    void append(int number, std::string& buffer) const;
+
+    /// Size of the value in bytes
+    size_t size(int number) const;
+
+  private:
+    enum class SizeType
+    {
+      Fixed, Uniform, LogNormal, File
+    };
+
+    enum class ContentType
+    {
+      Text, Random, Json
+    };
+
+    SizeType mSizeType;
+    ContentType mContentType;
+    double mFirst;
+    double mSecond;
+    std::vector<size_t> mSizes; ///< Sizes from the file
+};
+
+} // namespace ConfigurationBenchmark
+} // namespace AliceO2
+
+#endif // ALICEO2_CONFIGURATIONBENCHMARK_VALUEGENERATOR_H
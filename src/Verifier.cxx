@@ -0,0 +1,125 @@
+/// \file Verifier.cxx
+/// \brief Implementation of the VerificationIndex and Verifier classes.
+
+#include "Verifier.h"
+#include <limits>
+#include <stdexcept>
+#include "Hash.h"
+
+namespace AliceO2
+{
+namespace ConfigurationBenchmark
+{
+
+constexpr size_t VerificationIndex::npos;
+
+VerificationIndex::VerificationIndex(ParameterGenerator& expected)
+    : mSize(expected.size())
+{
+  if (mSize >= std::numeric_limits<uint32_t>::max()) {
+    throw std::runtime_error("Too many parameters to index");
+  }
+
+  // At most half full, so probe sequences stay short
+  size_t capacity = 16;
+  while (capacity < mSize * 2) {
+    capacity *= 2;
+  }
+  mMask = capacity - 1;
+  mSlots.assign(capacity, Slot{0, 0});
+  mValueHashes.resize(mSize);
+
+  for (size_t i = 0; i < mSize; ++i) {
+    auto parameter = expected.get(i);
+    auto keyHash = hash64(parameter.key);
+    mValueHashes[i] = hash64(parameter.value);
+    for (auto slot = keyHash & mMask;; slot = (slot + 1) & mMask) {
+      if (mSlots[slot].index == 0) {
+        mSlots[slot] = Slot{keyHash, uint32_t(i + 1)};
+        break;
+      }
+    }
+  }
+}
+
+size_t VerificationIndex::find(uint64_t keyHash) const
+{
+  for (auto slot = keyHash & mMask;; slot = (slot + 1) & mMask) {
+    const auto& entry = mSlots[slot];
+    if (entry.index == 0) {
+      return npos;
+    }
+    if (entry.keyHash == keyHash) {
+      return entry.index - 1;
+    }
+  }
+}
+
+Verifier::Verifier(const VerificationIndex* index, ParameterGenerator& expected, MismatchHandler onMismatch)
+    : mIndex(index), mExpected(expected), mOnMismatch(std::move(onMismatch)), mSeen(expected.size(), false),
+      mMismatches(0), mUnexpected(0), mReturned(0), mFailed(0)
+{
+}
+
+bool Verifier::check(boost::string_ref key, boost::string_ref value)
+{
+  mReturned++;
+  auto index = mIndex ? mIndex->find(hash64(key)) : mExpected.find(key);
+  if (index == ParameterGenerator::npos) {
+    mUnexpected++;
+    if (mOnMismatch) {
+      mOnMismatch(Mismatch{Mismatch::Type::Unexpected, key, boost::string_ref(), value});
+    }
+    return false;
+  }
+  mSeen[index] = true;
+
+  if (mIndex && mIndex->valueHash(index) == hash64(value)) {
+    return true;
+  }
+  auto expected = mExpected.get(index);
+  if (!mIndex && expected.value == value) {
+    return true;
+  }
+
+  mMismatches++;
+  if (mOnMismatch) {
+    mOnMismatch(Mismatch{Mismatch::Type::Different, key, expected.value, value});
+  }
+  return false;
+}
+
+void Verifier::accept(size_t begin, size_t end)
+{
+  for (size_t i = begin; i < end; ++i) {
+    mSeen[i] = true;
+  }
+  mReturned += end - begin;
+}
+
+void Verifier::fail(boost::string_ref key)
+{
+  mFailed++;
+  auto index = mIndex ? mIndex->find(hash64(key)) : mExpected.find(key);
+  if (index != ParameterGenerator::npos) {
+    mSeen[index] = true;
+  }
+}
+
+int Verifier::finish()
+{
+  int missing = 0;
+  for (size_t i = 0; i < mSeen.size(); ++i) {
+    if (!mSeen[i]) {
+      missing++;
+      if (mOnMismatch) {
+        auto expected = mExpected.get(i);
+        mOnMismatch(Mismatch{Mismatch::Type::Missing, expected.key, expected.value, boost::string_ref()});
+      }
+    }
+  }
+  return mMismatches + missing;
+}
+
+} // namespace ConfigurationBenchmark
+} // namespace AliceO2
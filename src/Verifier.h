@@ -0,0 +1,143 @@
+/// \file Verifier.h
+/// \brief Definition of the VerificationIndex and Verifier classes, which check returned parameters.
+
+#ifndef ALICEO2_CONFIGURATIONBENCHMARK_VERIFIER_H
+#define ALICEO2_CONFIGURATIONBENCHMARK_VERIFIER_H
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+#include <boost/utility/string_ref.hpp>
+#include "ParameterGenerator.h"
+
+namespace AliceO2
+{
+namespace ConfigurationBenchmark
+{
+
+/// Open-addressing hash table from the 64-bit hash of every expected key to its index and the 64-bit hash of its
+/// value. Looking up a returned parameter is then a hash of the key and value plus, usually, a single probe, instead
+/// of string comparisons. Keys are identified by their hash alone, the chance of a collision is negligible.
+///
+/// Immutable once built, so it can be shared by threads and, copy-on-write, by forked processes.
+class VerificationIndex
+{
+  public:
+    static constexpr size_t npos = size_t(-1);
+
+    /// Hashes all expected parameters
+    explicit VerificationIndex(ParameterGenerator& expected);
+
+    size_t size() const
+    {
+      return mSize;
+    }
+
+    /// \return Index of the parameter with the key hash, or npos if there is none
+    size_t find(uint64_t keyHash) const;
+
+    uint64_t valueHash(size_t index) const
+    {
+      return mValueHashes[index];
+    }
+
+  private:
+    struct Slot
+    {
+        uint64_t keyHash;
+        uint32_t index; ///< Index of the parameter plus one, 0 for an empty slot
+    };
+
+    size_t mSize;
+    uint64_t mMask;
+    std::vector<Slot> mSlots;
+    std::vector<uint64_t> mValueHashes; ///< By parameter index
+};
+
+/// Checks returned parameters against the expected ones, one at a time, in any order. Compares hashes from the
+/// index, and only generates the expected value to compare strings when the hashes differ. Without an index, it finds
+/// the parameters with the generator and compares the strings directly, which is how parameters generated on demand
+/// are checked without using memory per parameter.
+///
+/// One instance per check, it tracks which parameters were returned.
+class Verifier
+{
+  public:
+    struct Mismatch
+    {
+        enum class Type
+        {
+          Different, ///< The returned value differs from the expected one
+          Missing, ///< An expected parameter was not returned
+          Unexpected ///< A returned key is not one of the expected ones
+        };
+
+        Type type;
+        boost::string_ref key;
+        boost::string_ref expected; ///< Empty if unexpected
+        boost::string_ref returned; ///< Empty if missing
+    };
+
+    /// Called for every mismatch, for reporting. The string_refs are only valid during the call.
+    using MismatchHandler = std::function<void(const Mismatch&)>;
+
+    /// \param index Index of the expected parameters, or nullptr to use the generator instead
+    Verifier(const VerificationIndex* index, ParameterGenerator& expected, MismatchHandler onMismatch = nullptr);
+
+    /// Checks a returned parameter
+    /// \return True if it matches the expected one
+    bool check(boost::string_ref key, boost::string_ref value);
+
+    /// Counts a range of expected parameters as returned and matching, without checking them, for when they were
+    /// verified some other way
+    void accept(size_t begin, size_t end);
+
+    /// Counts an expected parameter as failed, for when its request returned no value. It is then not reported as
+    /// missing, as the error was already counted by the request.
+    void fail(boost::string_ref key);
+
+    /// Reports the expected parameters that were not returned
+    /// \return Number of mismatches: differing values plus missing parameters. Unexpected keys are not counted, like
+    ///   missing ones they show up as a difference between returned() and the number of expected parameters.
+    int finish();
+
+    /// Number of differing values so far
+    int mismatches() const
+    {
+      return mMismatches;
+    }
+
+    /// Number of returned keys so far that are not expected
+    int unexpected() const
+    {
+      return mUnexpected;
+    }
+
+    /// Number of parameters checked so far
+    size_t returned() const
+    {
+      return mReturned;
+    }
+
+    /// Number of parameters failed so far
+    size_t failed() const
+    {
+      return mFailed;
+    }
+
+  private:
+    const VerificationIndex* mIndex;
+    ParameterGenerator& mExpected;
+    MismatchHandler mOnMismatch;
+    std::vector<bool> mSeen; ///< By parameter index
+    int mMismatches;
+    int mUnexpected;
+    size_t mReturned;
+    size_t mFailed;
+};
+
+} // namespace ConfigurationBenchmark
+} // namespace AliceO2
+
+#endif // ALICEO2_CONFIGURATIONBENCHMARK_VERIFIER_H
@@ -0,0 +1,222 @@
+/// \file Watcher.cxx
+/// \brief Implementation of the Watcher class and its backends.
+
+#include "Watcher.h"
+#include <algorithm>
+#include <stdexcept>
+#include <boost/algorithm/string.hpp>
+#include "Clock.h"
+#include "Encoding.h"
+#include "HttpClient.h"
+#include "MockConfiguration.h"
+
+namespace AliceO2
+{
+namespace ConfigurationBenchmark
+{
+namespace
+{
+/// Removes the leading slashes
+std::string stripSlashes(const std::string& key)
+{
+  auto start = key.find_first_not_of('/');
+  return start == std::string::npos ? "" : key.substr(start);
+}
+
+/// Consul blocking queries: the request only returns when the index of the subtree passed the given one
+class ConsulWatcher : public Watcher
+{
+  public:
+    ConsulWatcher(const HttpUri& uri, const std::string& path, uint64_t pollInterval)
+        : mClient(uri.host, uri.port), mPrefix(stripSlashes(joinKey(uri.prefix, path))), mPollInterval(pollInterval),
+          mIndex(0), mFirst(true)
+    {
+      if (!mPrefix.empty() && mPrefix.back() != '/') {
+        mPrefix += '/';
+      }
+    }
+
+    virtual auto wait(uint64_t timeoutNanoseconds) -> boost::optional<KeyValues>
+    {
+      auto deadline = Clock::now() + timeoutNanoseconds;
+      while (true) {
+        auto now = Clock::now();
+        if (!mFirst && now >= deadline) {
+          return boost::none;
+        }
+
+        auto path = "/v1/kv/" + mPrefix + "?recurse";
+        if (!mFirst) {
+          auto waitMilliseconds = std::max<uint64_t>((deadline - now) / 1000000, 1);
+          path += "&index=" + std::to_string(mIndex) + "&wait=" + std::to_string(waitMilliseconds) + "ms";
+        }
+        auto response = mClient.request("GET", path, "");
+        if (response.status != 200 && response.status != 404) {
+          throw std::runtime_error("Consul blocking query failed with status " + std::to_string(response.status)
+              + ": " + response.body);
+        }
+
+        uint64_t index = 0;
+        auto header = response.headers.find("x-consul-index");
+        if (header != response.headers.end()) {
+          index = std::stoull(header->second);
+        }
+        bool indexChanged = index != mIndex;
+        // The index must increase, and may only go backwards when the server was reset
+        mIndex = index < mIndex ? 0 : index;
+
+        KeyValues keyValues;
+        if (response.status == 200) {
+          size_t position = 0;
+          while (true) {
+            auto key = jsonStringField(response.body, "Key", &position);
+            auto value = jsonStringField(response.body, "Value", &position);
+            if (position == std::string::npos) {
+              break;
+            }
+            keyValues.emplace(key.substr(std::min(key.size(), mPrefix.size())), base64Decode(value));
+          }
+        }
+
+        if (mFirst || keyValues != mKeyValues) {
+          mFirst = false;
+          mKeyValues = keyValues;
+          return keyValues;
+        }
+
+        if (!indexChanged) {
+          // Returned without changes before the wait was over, or the server does not support blocking
+          Clock::sleepUntil(std::min(deadline, Clock::now() + mPollInterval));
+        }
+      }
+    }
+
+    virtual std::string mechanism() const
+    {
+      return "consul-blocking-query";
+    }
+
+  private:
+    HttpClient mClient;
+    std::string mPrefix;
+    uint64_t mPollInterval;
+    uint64_t mIndex;
+    bool mFirst;
+    KeyValues mKeyValues;
+};
+
+/// Waits on the change notifications of the in-process store of the mock backend
+class MockWatcher : public Watcher
+{
+  public:
+    MockWatcher(const std::string& uri, const std::string& path)
+        : mStore(MockConfiguration::getStore(uri)), mPrefix(path), mVersion(0), mFirst(true)
+    {
+      if (!mPrefix.empty() && mPrefix.back() != '/') {
+        mPrefix += '/';
+      }
+    }
+
+    virtual auto wait(uint64_t timeoutNanoseconds) -> boost::optional<KeyValues>
+    {
+      auto deadline = Clock::now() + timeoutNanoseconds;
+      while (true) {
+        if (!mFirst) {
+          auto now = Clock::now();
+          if (now >= deadline) {
+            return boost::none;
+          }
+          auto version = mStore->waitForChange(mVersion, deadline - now);
+          if (version == mVersion) {
+            return boost::none;
+          }
+        }
+        mVersion = mStore->version();
+
+        KeyValues keyValues;
+        for (const auto& kv : mStore->getWithPrefix(mPrefix)) {
+          keyValues.emplace(kv.first.substr(mPrefix.size()), kv.second);
+        }
+        if (mFirst || keyValues != mKeyValues) {
+          mFirst = false;
+          mKeyValues = keyValues;
+          return keyValues;
+        }
+      }
+    }
+
+    virtual std::string mechanism() const
+    {
+      return "mock-notification";
+    }
+
+  private:
+    std::shared_ptr<MockStore> mStore;
+    std::string mPrefix;
+    uint64_t mVersion;
+    bool mFirst;
+    KeyValues mKeyValues;
+};
+
+/// Fallback for backends without a supported watch mechanism: recursive gets at a fixed interval
+class PollingWatcher : public Watcher
+{
+  public:
+    PollingWatcher(std::unique_ptr<Configuration::ConfigurationInterface> configuration, const std::string& path,
+        uint64_t pollInterval)
+        : mConfiguration(std::move(configuration)), mPath(path), mPollInterval(pollInterval), mFirst(true)
+    {
+    }
+
+    virtual auto wait(uint64_t timeoutNanoseconds) -> boost::optional<KeyValues>
+    {
+      auto deadline = Clock::now() + timeoutNanoseconds;
+      while (true) {
+        KeyValues keyValues;
+        auto tree = mConfiguration->getRecursive(mPath);
+        for (const auto& kv : Configuration::Tree::treeToKeyValues(tree)) {
+          keyValues.emplace(stripSlashes(kv.first), Configuration::Tree::convert<std::string>(kv.second));
+        }
+        if (mFirst || keyValues != mKeyValues) {
+          mFirst = false;
+          mKeyValues = keyValues;
+          return keyValues;
+        }
+
+        auto now = Clock::now();
+        if (now >= deadline) {
+          return boost::none;
+        }
+        Clock::sleepUntil(std::min(deadline, now + mPollInterval));
+      }
+    }
+
+    virtual std::string mechanism() const
+    {
+      return "polling";
+    }
+
+  private:
+    std::unique_ptr<Configuration::ConfigurationInterface> mConfiguration;
+    std::string mPath;
+    uint64_t mPollInterval;
+    bool mFirst;
+    KeyValues mKeyValues;
+};
+} // Anonymous namespace
+
+auto Watcher::create(const std::string& uri, const std::string& path,
+    const std::function<std::unique_ptr<Configuration::ConfigurationInterface>()>& makeConfiguration,
+    uint64_t pollInterval) -> std::unique_ptr<Watcher>
+{
+  if (MockConfiguration::isMockUri(uri)) {
+    return std::make_unique<MockWatcher>(uri, path);
+  }
+  if (boost::starts_with(uri, "consul://")) {
+    return std::make_unique<ConsulWatcher>(parseHttpUri(uri, "consul://", 8500), path, pollInterval);
+  }
+  return std::make_unique<PollingWatcher>(makeConfiguration(), path, pollInterval);
+}
+
+} // namespace ConfigurationBenchmark
+} // namespace AliceO2
@@ -0,0 +1,53 @@
+/// \file Watcher.h
+/// \brief Definition of the Watcher class, for waiting on changes of the key-values under a path.
+
+#ifndef ALICEO2_CONFIGURATIONBENCHMARK_WATCHER_H
+#define ALICEO2_CONFIGURATIONBENCHMARK_WATCHER_H
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <boost/optional.hpp>
+#include "Configuration/ConfigurationInterface.h"
+
+namespace AliceO2
+{
+namespace ConfigurationBenchmark
+{
+
+/// Waits for changes of the key-values under a path, using the watch mechanism of the backend where supported. The
+/// ConfigurationInterface has none, so Consul blocking queries ("consul://HOST:PORT/PREFIX") go directly over HTTP,
+/// and the mock backend uses the change notifications of its store. Other backends are polled. Not thread-safe.
+class Watcher
+{
+  public:
+    /// Keys are relative to the watched path, without leading slash
+    using KeyValues = std::map<std::string, std::string>;
+
+    virtual ~Watcher()
+    {
+    }
+
+    /// \param makeConfiguration Creates the configuration used for polling, only called if the backend has no
+    ///   supported watch mechanism
+    /// \param pollInterval Nanoseconds between polls, also the minimum time between blocking queries that return
+    ///   without changes, so a server that does not block is not hammered
+    static auto create(const std::string& uri, const std::string& path,
+        const std::function<std::unique_ptr<Configuration::ConfigurationInterface>()>& makeConfiguration,
+        uint64_t pollInterval) -> std::unique_ptr<Watcher>;
+
+    /// Waits until the key-values differ from the ones returned by the previous call, or the timeout passed. The
+    /// first call returns the current key-values right away.
+    /// \return The key-values, or none on timeout
+    virtual auto wait(uint64_t timeoutNanoseconds) -> boost::optional<KeyValues> = 0;
+
+    /// Name of the watch mechanism, for reporting
+    virtual std::string mechanism() const = 0;
+};
+
+} // namespace ConfigurationBenchmark
+} // namespace AliceO2
+
+#endif // ALICEO2_CONFIGURATIONBENCHMARK_WATCHER_H